@@ -0,0 +1,270 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/mpi/environment.hpp>
+#include <boost/mpi/packed_iarchive.hpp>
+#include <boost/mpi/packed_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include <dpa/benchmark/benchmark.hpp>
+#include <dpa/math/analytic_flows.hpp>
+#include <dpa/math/prime_factorization.hpp>
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/stages/integral_curve_saver.hpp>
+#include <dpa/stages/uniform_seed_generator.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/integral_curves.hpp>
+#include <dpa/types/integrators.hpp>
+#include <dpa/types/particle.hpp>
+#include <dpa/types/regular_fields.hpp>
+
+// Microbenchmarks of the core kernels. Runs as a single process (an MPI singleton), without mpiexec.
+// Usage: kernel_benchmarks [REPETITIONS] [OUTPUT_DIRECTORY]. The output directory (default /dev/shm) receives the curve saving files.
+// Prints one CSV line per kernel and parameter set: the mean and standard deviation of the time per operation over the repetitions, and the throughput.
+
+namespace
+{
+using namespace dpa;
+
+volatile scalar sink = 0; // Prevents the elimination of the benchmarked computations.
+
+std::size_t     repetitions = 10;
+
+template <typename function_type>
+void    benchmark(const std::string& name, const std::string& parameters, const std::size_t operations, const function_type& function)
+{
+  function(); // Warm up.
+
+  auto record = run<double, std::nano>(function, repetitions);
+  std::cout << name << "," << parameters << "," << record.mean() / operations << "," << record.standard_deviation() / operations << "," << operations * 1e9 / record.mean() << "\n";
+}
+
+regular_vector_field_3d make_field(const std::size_t size)
+{
+  regular_vector_field_3d field;
+  field.data.resize(boost::extents[size][size][size]);
+  field.offset .setZero();
+  field.spacing.setConstant(2 * analytic_flows::pi / (size - 1));
+  field.size   = field.spacing * (size - 1);
+  for (std::size_t x = 0; x < size; ++x)
+    for (std::size_t y = 0; y < size; ++y)
+      for (std::size_t z = 0; z < size; ++z)
+        field.data[x][y][z] = analytic_flows::abc(field.spacing.cwiseProduct(vector3(x, y, z)));
+  return field;
+}
+
+std::vector<vector3> make_positions(const regular_vector_field_3d& field, const std::size_t count, const scalar margin = scalar(0))
+{
+  std::mt19937                          engine      (0);
+  std::uniform_real_distribution<float> distribution(-margin, 1 + margin);
+  std::vector<vector3>                  positions   (count);
+  for (auto& position : positions)
+    position = field.offset + field.size.cwiseProduct(vector3(distribution(engine), distribution(engine), distribution(engine))) * scalar(0.999);
+  return positions;
+}
+
+void benchmark_regular_grid()
+{
+  for (const std::size_t grid_size : {32, 128, 256})
+  {
+    const auto field = make_field(grid_size);
+    for (const std::size_t batch_size : {1024, 65536})
+    {
+      const auto parameters = "grid " + std::to_string(grid_size) + "^3 batch " + std::to_string(batch_size);
+      const auto inside     = make_positions(field, batch_size);
+      const auto mixed      = make_positions(field, batch_size, scalar(0.1));
+
+      benchmark("regular_grid::contains"   , parameters, batch_size, [&] ()
+      {
+        std::size_t count = 0;
+        for (auto& position : mixed)
+          count += field.contains(position);
+        sink = sink + count;
+      });
+      benchmark("regular_grid::interpolate", parameters, batch_size, [&] ()
+      {
+        vector3 sum = vector3::Zero();
+        for (auto& position : inside)
+          sum += field.interpolate(position);
+        sink = sink + sum.sum();
+      });
+    }
+  }
+}
+
+template <typename integrator_type>
+void benchmark_integrator(const std::string& integrator_name, const regular_vector_field_3d& field)
+{
+  // Mirrors particle_advector::advect; a single interpolation per step. The particle is reseeded at the center when it leaves the field.
+  const vector3 center = field.offset + field.size / 2;
+  for (const std::size_t steps : {1024, 65536})
+  {
+    benchmark("do_step", integrator_name + " steps " + std::to_string(steps), steps, [&] ()
+    {
+      integrator_type integrator;
+      vector3         position = center;
+      for (std::size_t i = 0; i < steps; ++i)
+      {
+        if (!field.contains(position))
+          position = center;
+        const auto vector = field.interpolate(position);
+        const auto system = [&] (const vector3& x, vector3& dxdt, const float t) { dxdt = vector; };
+        integrator.do_step(system, position, i * scalar(0.01), scalar(0.01));
+      }
+      sink = sink + position.sum();
+    });
+  }
+}
+void benchmark_integrators()
+{
+  const auto field = make_field(64);
+  benchmark_integrator<euler_integrator                       <vector3>>("euler"                       , field);
+  benchmark_integrator<modified_midpoint_integrator           <vector3>>("modified_midpoint"           , field);
+  benchmark_integrator<runge_kutta_4_integrator               <vector3>>("runge_kutta_4"               , field);
+  benchmark_integrator<runge_kutta_cash_karp_54_integrator    <vector3>>("runge_kutta_cash_karp_54"    , field);
+  benchmark_integrator<runge_kutta_dormand_prince_5_integrator<vector3>>("runge_kutta_dormand_prince_5", field);
+  benchmark_integrator<runge_kutta_fehlberg_78_integrator     <vector3>>("runge_kutta_fehlberg_78"     , field);
+  benchmark_integrator<adams_bashforth_2_integrator           <vector3>>("adams_bashforth_2"           , field);
+  benchmark_integrator<adams_bashforth_moulton_2_integrator   <vector3>>("adams_bashforth_moulton_2"   , field);
+}
+
+void benchmark_seed_generators()
+{
+  const vector3 offset = vector3::Zero    ();
+  const vector3 size   = vector3::Constant(128);
+  for (const scalar stride : {4, 2, 1})
+  {
+    const auto count = std::size_t(std::pow(128 / stride, 3));
+    benchmark("uniform_seed_generator::generate"       , "stride " + std::to_string(std::size_t(stride)), count, [&] ()
+    {
+      sink = sink + uniform_seed_generator::generate       (offset, size, vector3::Constant(stride), 1000, 0).size();
+    });
+  }
+  for (const integer count : {1000, 100000, 1000000})
+  {
+    benchmark("uniform_seed_generator::generate_random", "count "  + std::to_string(count)              , count, [&] ()
+    {
+      sink = sink + uniform_seed_generator::generate_random(offset, size, count                   , 1000, 0).size();
+    });
+  }
+}
+
+void benchmark_partitioning()
+{
+  for (const integer value : {64, 1024, 65521, 1048576})
+  {
+    benchmark("prime_factorize", "value " + std::to_string(value), 1, [&] ()
+    {
+      sink = sink + prime_factorize(value).size();
+    });
+  }
+
+  domain_partitioner partitioner;
+  for (const integer domain_size : {64, 1024})
+  {
+    benchmark("domain_partitioner::set_domain_size", "domain " + std::to_string(domain_size) + "^3", 1, [&] ()
+    {
+      partitioner.set_domain_size(ivector3::Constant(domain_size), ivector3::Ones());
+      sink = sink + partitioner.block_size().sum();
+    });
+  }
+}
+
+void benchmark_serialization()
+{
+  boost::mpi::communicator communicator;
+  for (const std::size_t count : {1000, 100000})
+  {
+    auto seed = particle<vector3, integer>(vector3::Ones(), 1000);
+    seed.relative_direction = relative_direction::positive_x;
+    std::vector<particle<vector3, integer>> particles(count, seed);
+
+    benchmark("particle serialization"  , "count " + std::to_string(count), count, [&] ()
+    {
+      boost::mpi::packed_oarchive archive(communicator);
+      archive << particles;
+      sink = sink + archive.size();
+    });
+
+    boost::mpi::packed_oarchive output(communicator);
+    output << particles;
+    benchmark("particle deserialization", "count " + std::to_string(count), count, [&] ()
+    {
+      boost::mpi::packed_iarchive input(communicator);
+      input.resize(output.size());
+      std::copy_n(static_cast<const char*>(output.address()), output.size(), static_cast<char*>(input.address()));
+
+      std::vector<particle<vector3, integer>> result;
+      input >> result;
+      sink = sink + result.size();
+    });
+  }
+}
+
+void benchmark_curve_saving(const std::string& directory)
+{
+  domain_partitioner partitioner;
+  partitioner.set_domain_size(ivector3::Constant(64), ivector3::Ones());
+
+  const auto filepath = (std::filesystem::path(directory) / "dpa_kernel_benchmarks.h5").string();
+  for (const std::size_t curve_count : {1000, 10000})
+  {
+    for (const std::size_t curve_size : {100, 1000})
+    {
+      integral_curves_3d              integral_curves(1);
+      auto&                           curves       = integral_curves[0];
+      std::mt19937                    engine       (0);
+      std::normal_distribution<float> distribution (0.0f, 0.01f);
+      curves.vertices.resize(curve_count * curve_size);
+      curves.offsets .resize(curve_count + 1);
+      for (std::size_t i = 0; i < curve_count; ++i)
+      {
+        curves.offsets[i + 1] = (i + 1) * curve_size;
+        vector3 position = vector3::Constant(32);
+        for (auto j = curves.offsets[i]; j < curves.offsets[i + 1]; ++j)
+          curves.vertices[j] = position += vector3(distribution(engine), distribution(engine), distribution(engine));
+      }
+
+      for (const std::string topology : {"segments", "mixed", "offsets"})
+      {
+        for (const std::string encoding : {"raw", "quantized_delta"})
+        {
+          const auto parameters = "curves " + std::to_string(curve_count) + " size " + std::to_string(curve_size) + " " + topology + " " + encoding;
+          benchmark("integral_curve_saver::save_integral_curves", parameters, curves.vertex_count(), [&] ()
+          {
+            integral_curve_saver(&partitioner, filepath, topology, encoding).save_integral_curves(integral_curves);
+          });
+        }
+      }
+    }
+  }
+
+  for (auto& entry : std::filesystem::directory_iterator(directory))
+    if (entry.path().filename().string().rfind("dpa_kernel_benchmarks", 0) == 0)
+      std::filesystem::remove(entry.path());
+}
+}
+
+std::int32_t main(std::int32_t argc, char** argv)
+{
+  boost::mpi::environment environment(argc, argv, boost::mpi::threading::level::serialized);
+
+  if (argc > 1)
+    repetitions = std::stoul(argv[1]);
+  const std::string directory = argc > 2 ? argv[2] : "/dev/shm";
+
+  std::cout << "name,parameters,ns per op,ns per op standard deviation,items per second\n";
+  benchmark_regular_grid    ();
+  benchmark_integrators     ();
+  benchmark_seed_generators ();
+  benchmark_partitioning    ();
+  benchmark_serialization   ();
+  benchmark_curve_saving    (directory);
+  return 0;
+}
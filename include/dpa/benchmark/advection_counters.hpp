@@ -0,0 +1,80 @@
+#ifndef DPA_BENCHMARK_ADVECTION_COUNTERS_HPP
+#define DPA_BENCHMARK_ADVECTION_COUNTERS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <dpa/types/relative_direction.hpp>
+
+// Statements within DPA_COUNTER(...) are compiled only when DPA_COUNTER_SUPPORT is declared.
+#ifdef DPA_COUNTER_SUPPORT
+#define DPA_COUNTER(...) __VA_ARGS__
+#else
+#define DPA_COUNTER(...)
+#endif
+
+namespace dpa
+{
+// Hot path counters of particle_advector::advect. Accumulated per thread and combined per round.
+struct advection_counters
+{
+  using clock = std::chrono::high_resolution_clock;
+
+  static std::size_t  direction_index(const relative_direction direction)
+  {
+    // negative_x, positive_x, negative_y, positive_y, negative_z, positive_z.
+    return direction < 0 ? 2 * std::size_t(-direction) - 2 : 2 * std::size_t(direction) - 1;
+  }
+  static double       milliseconds   (const clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  }
+
+  advection_counters& operator+=(const advection_counters& that)
+  {
+    integration_steps        += that.integration_steps       ;
+    interpolations           += that.interpolations          ;
+    remote_interpolations    += that.remote_interpolations   ;
+    contains_failures        += that.contains_failures       ;
+    zero_vector_terminations += that.zero_vector_terminations;
+    load_balanced_handoffs   += that.load_balanced_handoffs  ;
+    for (std::size_t i = 0; i < handoffs.size(); ++i)
+      handoffs[i]            += that.handoffs[i]             ;
+    wait_time                += that.wait_time               ;
+    return *this;
+  }
+
+  static std::string  csv_header()
+  {
+    return "integration steps,interpolations,remote interpolations,contains failures,zero vector terminations,load balanced handoffs,"
+           "handoffs negative x,handoffs positive x,handoffs negative y,handoffs positive y,handoffs negative z,handoffs positive z,"
+           "wait time";
+  }
+  std::string         to_string () const
+  {
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << integration_steps << "," << interpolations << "," << remote_interpolations << "," << contains_failures << "," << zero_vector_terminations << "," << load_balanced_handoffs << ",";
+    for (auto& value : handoffs)
+      stream << value << ",";
+    stream << wait_time;
+    return stream.str();
+  }
+
+  std::uint64_t                integration_steps        = 0 ;
+  std::uint64_t                interpolations           = 0 ;
+  std::uint64_t                remote_interpolations    = 0 ; // Interpolations in a cell whose page resides on another NUMA node than the thread.
+  std::uint64_t                contains_failures        = 0 ; // Particles leaving the (possibly load balanced) block.
+  std::uint64_t                zero_vector_terminations = 0 ; // Including the particles below the minimum speed of the termination criteria.
+  std::uint64_t                load_balanced_handoffs   = 0 ; // Load balanced particles returned to their block.
+  std::array<std::uint64_t, 6> handoffs                 {}; // Out of bounds particles handed to a neighbor, per direction_index.
+  double                       wait_time                = 0 ; // Milliseconds spent waiting on the output mutex and the out of bounds accessors.
+};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define DPA_BENCHMARK_BENCHMARK_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstddef>
@@ -10,8 +11,10 @@
 #include <functional>
 #include <limits>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <mpi.h>
@@ -57,13 +60,49 @@ struct record
     stream << to_string();
   }
 
-  std::string       name  ;
-  std::vector<type> values;
+  std::string samples_to_string ()
+  {
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<type>::max_digits10);
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      stream << name << "," << i;
+      for (auto& sample : samples[i])
+        stream << "," << sample;
+      stream << "\n";
+    }
+    return stream.str();
+  }
+
+  std::string                    name    ;
+  std::vector<type>              values  ; // Per iteration. The sum of the samples when the stage is recorded more than once per iteration.
+  std::vector<std::vector<type>> samples {}; // Per iteration, one per recording (e.g. one per round).
+  std::size_t                    parent  = std::numeric_limits<std::size_t>::max();
 };
 
+// Small, stable index of the calling thread, for timelines.
+inline std::size_t thread_index()
+{
+  static std::atomic<std::size_t> counter {0};
+  thread_local const std::size_t  index = counter++;
+  return index;
+}
+
 template <typename type = double>
 struct session
 {
+  using clock = std::chrono::high_resolution_clock;
+
+  // A single recording of a record, in microseconds since the epoch of the session.
+  struct trace_event
+  {
+    std::size_t record   ;
+    std::size_t iteration;
+    std::size_t thread   ;
+    double      start    ;
+    double      end      ;
+  };
+
   virtual ~session() = default;
 
   virtual std::string to_string()
@@ -82,10 +121,70 @@ struct session
     stream << "mean,variance,standard deviation\n";
     stream << to_string();
   }
+  virtual std::string samples_to_string()
+  {
+    std::ostringstream stream;
+    for (auto& record : records)
+      stream << record.samples_to_string();
+    return stream.str();
+  }
+  virtual void        samples_to_csv   (const std::string& filepath)
+  {
+    std::ofstream stream(filepath);
+    stream << "name,iteration,samples\n";
+    stream << samples_to_string();
+  }
+  // Chrome trace event format (chrome://tracing, Perfetto). One complete event per line, each followed by a comma.
+  std::string         trace_to_string  (const std::int32_t process = 0)
+  {
+    std::ostringstream stream;
+    stream.precision(std::numeric_limits<double>::max_digits10);
+    stream << R"({"name":"process_name","ph":"M","pid":)" << process << R"(,"args":{"name":"rank )" << process << R"("}},)" << "\n";
+    for (auto& event : trace_events)
+      stream << R"({"name":")" << records[event.record].name << R"(","cat":"stage","ph":"X","pid":)" << process << R"(,"tid":)" << event.thread
+             << R"(,"ts":)" << event.start << R"(,"dur":)" << event.end - event.start << R"(,"args":{"iteration":)" << event.iteration << "}},\n";
+    return stream.str();
+  }
+  virtual void        trace_to_json    (const std::string& filepath)
+  {
+    write_trace(filepath, trace_to_string());
+  }
+
+  std::vector<record<type>>                    records        ;
+  std::unordered_map<std::string, std::size_t> record_indices ; // Name to index into records.
+  std::vector<trace_event>                     trace_events   ;
+  clock::time_point                            epoch          = clock::now();
 
-  std::vector<record<type>> records;
+protected:
+  static void         write_trace      (const std::string& filepath, std::string events)
+  {
+    if (events.size() >= 2)
+      events.erase(events.size() - 2, 1); // The trailing comma.
+    std::ofstream stream(filepath);
+    stream << "{\"traceEvents\":[\n" << events << "]}\n";
+  }
 };
 
+// Concatenates the strings of all ranks in rank order on the master rank. Returns an empty string on the other ranks.
+inline std::string mpi_gather_string(const std::string& local_string, MPI_Comm communicator = MPI_COMM_WORLD, std::int32_t master_rank = 0)
+{
+  std::int32_t rank, size;
+  MPI_Comm_rank(communicator, &rank);
+  MPI_Comm_size(communicator, &size);
+
+  std::int32_t local_size = local_string.size();
+
+  std::vector<std::int32_t> sizes        (size);
+  std::vector<std::int32_t> displacements(size);
+  std::int32_t              counter = 0;
+  MPI_Gather (&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, master_rank, communicator);
+  for (auto i = 0; i < size; ++i)
+    displacements[i] = counter, counter += sizes[i];
+  std::string gathered(rank == master_rank ? counter : 0, '\0');
+  MPI_Gatherv(local_string.data(), local_string.size(), MPI_CHAR, gathered.data(), sizes.data(), displacements.data(), MPI_CHAR, master_rank, communicator);
+  return gathered;
+}
+
 template <typename type = double>
 class  mpi_session : public session<type>
 {
@@ -94,6 +193,10 @@ public:
   {
     MPI_Comm_rank(communicator_, &rank_);
     MPI_Comm_size(communicator_, &size_);
+
+    // Aligns the epochs of the ranks for the timeline, to within the latency of the barrier.
+    MPI_Barrier(communicator_);
+    session<type>::epoch = session<type>::clock::now();
   }
   mpi_session           (const mpi_session&  that) = default;
   mpi_session           (      mpi_session&& temp) = default;
@@ -106,17 +209,18 @@ public:
     std::ostringstream stream;
     for (auto& record : session<type>::records)
       stream << rank_ << "," << record.to_string() << "\n";
-    std::string  local_string = stream      .str ();
-    std::int32_t local_size   = local_string.size();
-    
-    std::vector<std::int32_t> sizes        (size_);
-    std::vector<std::int32_t> displacements(size_);
-    std::int32_t              counter = 0;
-    MPI_Gather (&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, master_rank_, communicator_);
-    for (auto i = 0; i < size_; ++i)
-      displacements[i] = counter, counter += sizes[i];
-    gathered_.resize(counter);
-    MPI_Gatherv(local_string.data(), local_string.size(), MPI_CHAR, gathered_.data(), sizes.data(), displacements.data(), MPI_CHAR, master_rank_, communicator_);
+    gathered_ = mpi_gather_string(stream.str(), communicator_, master_rank_);
+
+    std::ostringstream samples_stream;
+    for (auto& record : session<type>::records)
+    {
+      std::istringstream lines(record.samples_to_string());
+      for (std::string line; std::getline(lines, line);)
+        samples_stream << rank_ << "," << line << "\n";
+    }
+    gathered_samples_ = mpi_gather_string(samples_stream.str(), communicator_, master_rank_);
+
+    gathered_trace_   = mpi_gather_string(session<type>::trace_to_string(rank_), communicator_, master_rank_);
   }
   virtual std::string to_string()                            override
   {
@@ -134,19 +238,65 @@ public:
     stream << "mean,variance,standard deviation\n";
     stream << to_string();
   }
+  virtual std::string samples_to_string()                            override
+  {
+    return rank_ == master_rank_ ? gathered_samples_ : session<type>::samples_to_string();
+  }
+  virtual void        samples_to_csv   (const std::string& filepath) override
+  {
+    if (rank_ != master_rank_)
+      return;
+
+    std::ofstream stream(filepath);
+    stream << "rank,name,iteration,samples\n";
+    stream << samples_to_string();
+  }
+  virtual void        trace_to_json    (const std::string& filepath) override
+  {
+    if (rank_ == master_rank_)
+      session<type>::write_trace(filepath, gathered_trace_);
+  }
   
 protected:
-  MPI_Comm     communicator_;
-  std::int32_t master_rank_ ;
-  std::int32_t rank_        ;
-  std::int32_t size_        ;
-  std::string  gathered_    ;
+  MPI_Comm     communicator_    ;
+  std::int32_t master_rank_     ;
+  std::int32_t rank_            ;
+  std::int32_t size_            ;
+  std::string  gathered_        ;
+  std::string  gathered_samples_;
+  std::string  gathered_trace_  ;
 };
 
 template <typename type = double, typename period = std::milli>
 class  session_recorder
 {
 public:
+  using stage_id = std::size_t;
+
+  // Accumulates the time from its construction to its destruction into the stage. Nested scopes nest naturally.
+  class  scoped_timer
+  {
+  public:
+    explicit scoped_timer  (session_recorder& recorder, const stage_id stage)
+    : recorder_(recorder), stage_(stage), start_(std::chrono::high_resolution_clock::now())
+    {
+
+    }
+    scoped_timer           (const scoped_timer&  that) = delete;
+    scoped_timer           (      scoped_timer&& temp) = delete;
+   ~scoped_timer           ()
+    {
+      recorder_.add_sample(stage_, start_, std::chrono::high_resolution_clock::now());
+    }
+    scoped_timer& operator=(const scoped_timer&  that) = delete;
+    scoped_timer& operator=(      scoped_timer&& temp) = delete;
+
+  protected:
+    session_recorder&                                           recorder_;
+    stage_id                                                    stage_   ;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start_   ;
+  };
+
   explicit session_recorder  (const std::size_t index, const std::size_t iterations, session<type>& session) 
   : index_(index), iterations_(iterations), session_(session)
   {
@@ -157,21 +307,53 @@ public:
   virtual ~session_recorder  ()                              = default;
   session_recorder& operator=(const session_recorder&  that) = delete ;
   session_recorder& operator=(      session_recorder&& temp) = default;
-  
-  void record(const std::string& name, const std::function<void()>& function)
+
+  // Returns the identifier of the stage, creating its record on first use. The identifiers are stable across iterations.
+  // A child stage is named "<parent name>/<name>". Intern once outside of hot loops; recording by identifier involves no lookups.
+  stage_id     intern    (const std::string& name, const std::optional<stage_id> parent = std::nullopt)
   {
-    const auto start = std::chrono::high_resolution_clock::now();
-    function();
-    const auto end   = std::chrono::high_resolution_clock::now();
+    const auto full_name = parent ? session_.records[*parent].name + "/" + name : name;
+    const auto iterator  = session_.record_indices.find(full_name);
+    if (iterator != session_.record_indices.end())
+      return iterator->second;
 
-    auto record = std::find_if(session_.records.begin(), session_.records.end(),
-      [&name] (const dpa::record<type>& record) { return record.name == name; });
-    if (record == session_.records.end())
-    {
-      session_.records.push_back({name, {std::vector<type>(iterations_)}});
-      record = std::prev(session_.records.end());
-    }
-    record->values[index_] = std::chrono::duration<type, period>(end - start).count();
+    session_.records.push_back({full_name, std::vector<type>(iterations_), std::vector<std::vector<type>>(iterations_), parent.value_or(std::numeric_limits<std::size_t>::max())});
+    return session_.record_indices[full_name] = session_.records.size() - 1;
+  }
+  scoped_timer time      (const stage_id stage)
+  {
+    return scoped_timer(*this, stage);
+  }
+  void         add_sample(const stage_id stage, const type value)
+  {
+    auto& record = session_.records[stage];
+    record.values [index_] += value;
+    record.samples[index_].push_back(value);
+  }
+  void         add_sample(const stage_id stage, const typename session<type>::clock::time_point start, const typename session<type>::clock::time_point end)
+  {
+    add_sample(stage, std::chrono::duration<type, period>(end - start).count());
+
+    const auto start_time = std::chrono::duration<double, std::micro>(start - session_.epoch).count();
+    const auto end_time   = std::chrono::duration<double, std::micro>(end   - session_.epoch).count();
+    session_.trace_events.push_back({stage, index_, thread_index(), start_time, end_time});
+  }
+  // The latest sample of the stage in the current iteration, e.g. of the current round.
+  type         last_sample(const stage_id stage) const
+  {
+    const auto& samples = session_.records[stage].samples[index_];
+    return samples.empty() ? type(0) : samples.back();
+  }
+
+  template <typename function_type>
+  void         record    (const stage_id     stage, const function_type&          function)
+  {
+    scoped_timer timer(*this, stage);
+    function();
+  }
+  void         record    (const std::string& name , const std::function<void()>& function)
+  {
+    record(intern(name), function);
   }
 
 protected:
@@ -180,9 +362,13 @@ protected:
   session<type>&    session_   ;
 };
 
+// The warmup iterations precede the iterations and are excluded from the results.
 template<typename type = double, typename period = std::milli>
-record<type>      run    (const std::function<void()>&                                function, const std::size_t iterations = 1)
+record<type>      run    (const std::function<void()>&                                function, const std::size_t iterations = 1, const std::size_t warmup_iterations = 0)
 {
+  for (std::size_t i = 0; i < warmup_iterations; ++i)
+    function();
+
   record<type> record {"", std::vector<type>(iterations)};
   for (auto i = 0; i < iterations; ++i)
   {
@@ -194,8 +380,15 @@ record<type>      run    (const std::function<void()>&
   return record;
 }
 template<typename type = double, typename period = std::milli>
-session<type>     run    (const std::function<void(session_recorder<type, period>&)>& function, const std::size_t iterations = 1)
+session<type>     run    (const std::function<void(session_recorder<type, period>&)>& function, const std::size_t iterations = 1, const std::size_t warmup_iterations = 0)
 {
+  for (std::size_t i = 0; i < warmup_iterations; ++i)
+  {
+    session<type>                  warmup_session;
+    session_recorder<type, period> recorder(0, 1, warmup_session);
+    function(recorder);
+  }
+
   session<type> session;
   for(auto i = 0; i < iterations; ++i)
   {
@@ -205,8 +398,15 @@ session<type>     run    (const std::function<void(session_recorder<type, period
   return session;
 }
 template<typename type = double, typename period = std::milli>
-mpi_session<type> run_mpi(const std::function<void(session_recorder<type, period>&)>& function, const std::size_t iterations = 1, const MPI_Comm communicator = MPI_COMM_WORLD, const std::int32_t master_rank = 0)
+mpi_session<type> run_mpi(const std::function<void(session_recorder<type, period>&)>& function, const std::size_t iterations = 1, const std::size_t warmup_iterations = 0, const MPI_Comm communicator = MPI_COMM_WORLD, const std::int32_t master_rank = 0)
 {
+  for (std::size_t i = 0; i < warmup_iterations; ++i)
+  {
+    session<type>                  warmup_session;
+    session_recorder<type, period> recorder(0, 1, warmup_session);
+    function(recorder);
+  }
+
   mpi_session<type> session(communicator, master_rank);
   for (auto i = 0; i < iterations; ++i)
   {
@@ -0,0 +1,97 @@
+#ifndef DPA_BENCHMARK_SCALING_METRICS_HPP
+#define DPA_BENCHMARK_SCALING_METRICS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include <dpa/benchmark/benchmark.hpp>
+
+namespace dpa
+{
+// Derived scalability metrics of the rounds, reduced over the ranks and written as JSON on the master rank:
+// - Particle steps per second: The particle steps of all ranks over the wall time of the rounds, i.e. the sum of the slowest rank's time per round.
+// - Imbalance per round: The maximum over the mean across ranks of the advection time and the particle steps. 1 is perfectly balanced.
+// The rounds are timed by round_record and the advection by advection_record of the session. The particle steps are per iteration, per round.
+// Parallel efficiency requires runs at several scales; see utility/python/scaling_driver.py.
+template <typename type = double, typename period = std::milli>
+void write_scaling_metrics(
+  const std::string&                           filepath        ,
+  const session<type>&                         session         ,
+  const std::size_t                            round_record    ,
+  const std::size_t                            advection_record,
+  const std::vector<std::vector<std::size_t>>& particle_steps  ,
+  const std::size_t                            thread_count    ,
+  const MPI_Comm                               communicator    = MPI_COMM_WORLD,
+  const std::int32_t                           master_rank     = 0)
+{
+  std::int32_t rank, size;
+  MPI_Comm_rank(communicator, &rank);
+  MPI_Comm_size(communicator, &size);
+
+  const auto to_seconds = [ ] (const double value) { return std::chrono::duration<double>(std::chrono::duration<double, period>(value)).count(); };
+  const auto imbalance  = [&] (const double maximum, const double sum) { return sum > 0.0 ? maximum / (sum / size) : 1.0; };
+
+  std::ostringstream stream;
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  stream << "{\n  \"ranks\": " << size << ",\n  \"threads\": " << thread_count << ",\n  \"iterations\": [";
+
+  std::vector<double> rates;
+  for (std::size_t iteration = 0; iteration < particle_steps.size(); ++iteration)
+  {
+    const auto round_count = particle_steps[iteration].size();
+
+    std::vector<double> round_times    (round_count), maximum_round_times    (round_count);
+    std::vector<double> advection_times(round_count), maximum_advection_times(round_count), sum_advection_times(round_count);
+    std::vector<double> steps          (round_count), maximum_steps          (round_count), sum_steps          (round_count);
+    for (std::size_t round = 0; round < round_count; ++round)
+    {
+      round_times    [round] = session.records[round_record    ].samples[iteration][round];
+      advection_times[round] = session.records[advection_record].samples[iteration][round];
+      steps          [round] = double(particle_steps[iteration][round]);
+    }
+    MPI_Reduce(round_times    .data(), maximum_round_times    .data(), round_count, MPI_DOUBLE, MPI_MAX, master_rank, communicator);
+    MPI_Reduce(advection_times.data(), maximum_advection_times.data(), round_count, MPI_DOUBLE, MPI_MAX, master_rank, communicator);
+    MPI_Reduce(advection_times.data(), sum_advection_times    .data(), round_count, MPI_DOUBLE, MPI_SUM, master_rank, communicator);
+    MPI_Reduce(steps          .data(), maximum_steps          .data(), round_count, MPI_DOUBLE, MPI_MAX, master_rank, communicator);
+    MPI_Reduce(steps          .data(), sum_steps              .data(), round_count, MPI_DOUBLE, MPI_SUM, master_rank, communicator);
+
+    const auto wall_time   = to_seconds(std::accumulate(maximum_round_times.begin(), maximum_round_times.end(), 0.0));
+    const auto total_steps = std::accumulate(sum_steps.begin(), sum_steps.end(), 0.0);
+    const auto rate        = wall_time > 0.0 ? total_steps / wall_time : 0.0;
+    rates.push_back(rate);
+
+    stream << (iteration ? "," : "") << "\n    {\n";
+    stream << "      \"particle_steps\": "            << total_steps << ",\n";
+    stream << "      \"wall_time\": "                 << wall_time   << ",\n";
+    stream << "      \"particle_steps_per_second\": " << rate        << ",\n";
+    stream << "      \"rounds\": [";
+    for (std::size_t round = 0; round < round_count; ++round)
+    {
+      stream << (round ? "," : "") << "\n        {";
+      stream << "\"particle_steps\": "      << sum_steps[round]                                                               << ", ";
+      stream << "\"wall_time\": "           << to_seconds(maximum_round_times[round])                                         << ", ";
+      stream << "\"advection_imbalance\": " << imbalance(maximum_advection_times[round], sum_advection_times[round])           << ", ";
+      stream << "\"step_imbalance\": "      << imbalance(maximum_steps          [round], sum_steps          [round])           << "}";
+    }
+    stream << "\n      ]\n    }";
+  }
+
+  const auto mean_rate = rates.empty() ? 0.0 : std::accumulate(rates.begin(), rates.end(), 0.0) / rates.size();
+  stream << "\n  ],\n  \"particle_steps_per_second\": " << mean_rate << "\n}\n";
+
+  if (rank == master_rank)
+    std::ofstream(filepath) << stream.str();
+}
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef DPA_MATH_ANALYTIC_FLOWS_HPP
+#define DPA_MATH_ANALYTIC_FLOWS_HPP
+
+#include <cmath>
+
+#include <dpa/types/basic_types.hpp>
+
+namespace dpa
+{
+// Stationary analytic flows, each defined over the domain [0, extent] of its natural extent.
+namespace analytic_flows
+{
+constexpr scalar pi = scalar(3.14159265358979323846);
+
+// Arnold-Beltrami-Childress flow. Extent (2 pi, 2 pi, 2 pi).
+inline vector3 abc           (const vector3& position, const scalar a = std::sqrt(scalar(3)), const scalar b = std::sqrt(scalar(2)), const scalar c = scalar(1))
+{
+  return vector3(
+    a * std::sin(position[2]) + c * std::cos(position[1]),
+    b * std::sin(position[0]) + a * std::cos(position[2]),
+    c * std::sin(position[1]) + b * std::cos(position[0]));
+}
+// Double gyre at t = 0, extruded along z. Extent (2, 1, 1).
+inline vector3 double_gyre   (const vector3& position, const scalar amplitude = scalar(0.1))
+{
+  return vector3(
+    -pi * amplitude * std::sin(pi * position[0]) * std::cos(pi * position[1]),
+     pi * amplitude * std::cos(pi * position[0]) * std::sin(pi * position[1]),
+     scalar(0));
+}
+// Rankine vortex about the z axis through the center, with a unit maximum tangential velocity at the core radius. Extent (2, 2, 2).
+inline vector3 rankine_vortex(const vector3& position, const vector3& center = vector3(1, 1, 1), const scalar core_radius = scalar(0.2))
+{
+  const vector3 relative  = position - center;
+  const scalar  radius    = std::hypot(relative[0], relative[1]);
+  const scalar  velocity  = radius < core_radius ? radius / core_radius : core_radius / radius;
+  return radius > scalar(0) ? vector3(-relative[1] / radius * velocity, relative[0] / radius * velocity, scalar(0)) : vector3::Zero().eval();
+}
+// Uniform flow along x. Extent (1, 1, 1).
+inline vector3 uniform       (const vector3& position)
+{
+  return vector3(1, 0, 0);
+}
+}
+}
+
+#endif
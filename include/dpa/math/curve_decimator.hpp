@@ -0,0 +1,122 @@
+#ifndef DPA_MATH_CURVE_DECIMATOR_HPP
+#define DPA_MATH_CURVE_DECIMATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace dpa
+{
+// Decimates a curve online, as its vertices are produced one at a time. A vertex is emitted when:
+// - It is the first or the last vertex of the curve.
+// - Stride vertices have been produced since the last emitted vertex.
+// - The arc length since the last emitted vertex reaches the spacing (if any).
+// - The chord from the last emitted vertex to the next vertex would deviate more than the tolerance (if any) from a vertex in between.
+// - The window of vertices skipped since the last emitted vertex is full (with the tolerance only).
+// The stride and the window bound the number of vertices inspected per tolerance check. The default emits every vertex. With the
+// spacing or the tolerance, pass std::numeric_limits<std::size_t>::max() as the stride to emit by these (and the window) alone.
+// Ducks Eigen's .norm(), .dot() and .squaredNorm() on the vector_type.
+template <typename vector_type, typename scalar_type = typename vector_type::Scalar>
+class curve_decimator
+{
+public:
+  static constexpr std::size_t default_window = 64;
+
+  explicit curve_decimator  (const std::size_t stride = 1, const std::optional<scalar_type> spacing = std::nullopt, const std::optional<scalar_type> tolerance = std::nullopt, const std::size_t window = default_window)
+  : stride_(std::max(stride, std::size_t(1))), spacing_(spacing), tolerance_(tolerance), window_(std::max(window, std::size_t(1)))
+  {
+
+  }
+  curve_decimator           (const curve_decimator&  that) = default;
+  curve_decimator           (      curve_decimator&& temp) = default;
+ ~curve_decimator           ()                             = default;
+  curve_decimator& operator=(const curve_decimator&  that) = default;
+  curve_decimator& operator=(      curve_decimator&& temp) = default;
+
+  template <typename emit_type>
+  void begin(const vector_type& vertex, const emit_type& emit)
+  {
+    skipped_.clear();
+    emit_anchor(vertex, emit);
+  }
+  template <typename emit_type>
+  void push (const vector_type& vertex, const emit_type& emit)
+  {
+    ++steps_;
+    arc_length_ += (vertex - last_).norm();
+
+    if (tolerance_ && deviates(vertex))
+    {
+      // The previous vertex becomes the anchor and the current one is reconsidered with respect to it.
+      emit_anchor(last_, emit);
+      steps_      = 1;
+      arc_length_ = (vertex - anchor_).norm();
+    }
+
+    if (is_forced())
+      emit_anchor(vertex, emit);
+    else
+    {
+      if (tolerance_)
+        skipped_.push_back(vertex);
+      last_         = vertex;
+      last_emitted_ = false;
+    }
+  }
+  template <typename emit_type>
+  void end  (const emit_type& emit)
+  {
+    if (!last_emitted_)
+      emit_anchor(last_, emit);
+  }
+
+  // An upper bound of the vertices emitted for a curve of the given number of steps, including its first and last vertex.
+  std::size_t maximum_vertices(const std::size_t steps) const
+  {
+    return spacing_ || tolerance_ ? steps + 1 : steps / stride_ + 2;
+  }
+
+protected:
+  template <typename emit_type>
+  void emit_anchor(const vector_type& vertex, const emit_type& emit)
+  {
+    emit(vertex);
+    anchor_       = vertex;
+    last_         = vertex;
+    last_emitted_ = true;
+    steps_        = 0;
+    arc_length_   = scalar_type(0);
+    skipped_.clear();
+  }
+  bool is_forced  () const
+  {
+    return steps_ >= stride_ || (spacing_ && arc_length_ >= *spacing_) || (tolerance_ && skipped_.size() >= window_);
+  }
+  bool deviates   (const vector_type& vertex) const
+  {
+    const vector_type chord          = vertex - anchor_;
+    const scalar_type chord_length_2 = chord.squaredNorm();
+    const scalar_type tolerance_2    = *tolerance_ * *tolerance_;
+    return std::any_of(skipped_.begin(), skipped_.end(), [&] (const vector_type& skipped)
+    {
+      const scalar_type t = chord_length_2 > scalar_type(0) ? std::clamp((skipped - anchor_).dot(chord) / chord_length_2, scalar_type(0), scalar_type(1)) : scalar_type(0);
+      return (skipped - (anchor_ + t * chord)).squaredNorm() > tolerance_2;
+    });
+  }
+
+  std::size_t                stride_       = 1;
+  std::optional<scalar_type> spacing_      = std::nullopt;
+  std::optional<scalar_type> tolerance_    = std::nullopt;
+  std::size_t                window_       = default_window; // The maximum skipped vertices inspected per tolerance check.
+
+  vector_type                anchor_       {};
+  vector_type                last_         {};
+  bool                       last_emitted_ = true;
+  std::size_t                steps_        = 0;
+  scalar_type                arc_length_   = scalar_type(0);
+  std::vector<vector_type>   skipped_      {};
+};
+}
+
+#endif
\ No newline at end of file
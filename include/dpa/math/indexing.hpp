@@ -24,7 +24,7 @@ template <typename type>
 std::size_t ravel_multi_index(const type& multi_index, const type& dimensions)
 {
   std::size_t index(0);
-  for (std::size_t i = 0; i < dimensions.size(); ++i)
+  for (std::size_t i = 0; i < std::size_t(dimensions.size()); ++i)
     index = index * dimensions[i] + multi_index[i];
   return index;
 }
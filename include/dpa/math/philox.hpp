@@ -0,0 +1,49 @@
+#ifndef DPA_MATH_PHILOX_HPP
+#define DPA_MATH_PHILOX_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace dpa
+{
+// Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011).
+// Stateless: each (counter, key) pair maps to four independent 32-bit values, hence any element of a sequence is generated
+// in constant time and independently of the thread or order in which it is requested.
+class philox
+{
+public:
+  using counter_type = std::array<std::uint32_t, 4>;
+  using key_type     = std::array<std::uint32_t, 2>;
+
+  static constexpr counter_type generate(counter_type counter, key_type key)
+  {
+    for (auto round = 0; round < 10; ++round)
+    {
+      if (round > 0)
+      {
+        key[0] += 0x9E3779B9;
+        key[1] += 0xBB67AE85;
+      }
+
+      const auto product_0 = std::uint64_t(0xD2511F53) * counter[0];
+      const auto product_1 = std::uint64_t(0xCD9E8D57) * counter[2];
+      counter =
+      {
+        std::uint32_t(product_1 >> 32) ^ counter[1] ^ key[0],
+        std::uint32_t(product_1      ),
+        std::uint32_t(product_0 >> 32) ^ counter[3] ^ key[1],
+        std::uint32_t(product_0      )
+      };
+    }
+    return counter;
+  }
+
+  // Maps to [0, 1) using the upper 24 bits, i.e. the float mantissa.
+  static constexpr float        to_unit (const std::uint32_t value)
+  {
+    return float(value >> 8) * (1.0f / 16777216.0f);
+  }
+};
+}
+
+#endif
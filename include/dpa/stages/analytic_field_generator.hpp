@@ -0,0 +1,52 @@
+#ifndef DPA_STAGES_ANALYTIC_FIELD_GENERATOR_HPP
+#define DPA_STAGES_ANALYTIC_FIELD_GENERATOR_HPP
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/regular_fields.hpp>
+#include <dpa/types/relative_direction.hpp>
+
+namespace dpa
+{
+// Drop-in replacement for the regular_grid_loader which samples an analytic flow (see analytic_flows) instead of reading a dataset.
+// Each rank fills its own (ghosted) blocks in parallel, hence the domain may be of any size without I/O.
+class analytic_field_generator
+{
+public:
+  enum class type
+  {
+    abc           ,
+    double_gyre   ,
+    rankine_vortex,
+    uniform
+  };
+
+  // The spacing defaults to sampling the natural extent of the flow with the given dimensions.
+  explicit analytic_field_generator  (domain_partitioner* partitioner, const std::string& type, const ivector3& dimensions, const std::optional<vector3>& spacing = std::nullopt);
+  analytic_field_generator           (const analytic_field_generator&  that) = delete ;
+  analytic_field_generator           (      analytic_field_generator&& temp) = default;
+ ~analytic_field_generator           ()                                      = default;
+  analytic_field_generator& operator=(const analytic_field_generator&  that) = delete ;
+  analytic_field_generator& operator=(      analytic_field_generator&& temp) = default;
+
+  ivector3                                                        load_dimensions   ();
+  std::unordered_map<relative_direction, regular_vector_field_3d> load_vector_fields(const bool load_neighbors);
+
+  static vector3                                                  extent            (type flow);
+
+protected:
+  regular_vector_field_3d                                         load_vector_field (const ivector3& offset, const ivector3& size) const;
+  vector3                                                         evaluate          (const vector3& position) const;
+
+  domain_partitioner* partitioner_ = nullptr;
+  type                type_        = type::abc;
+  ivector3            dimensions_  = {};
+  vector3             spacing_     = {};
+};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef DPA_STAGES_FTLE_ESTIMATOR_HPP
+#define DPA_STAGES_FTLE_ESTIMATOR_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/particle.hpp>
+#include <dpa/types/regular_fields.hpp>
+
+namespace dpa
+{
+// Estimates the finite-time Lyapunov exponent field on the seed grid of uniform_seed_generator::generate from the flow map, i.e.
+// the original and final positions of the particles gathered on their original ranks (requires DPA_FTLE_SUPPORT). The faces of
+// the flow map are exchanged with the neighbors for central differences across blocks, falling back to one-sided differences at
+// the domain boundaries. The FTLE of each seed is ln(sqrt(lambda_max(C))) / |T|, where C is the right Cauchy-Green tensor and T
+// the integration time of the particle of the seed, which is shorter than the iterations times the step size if the particle
+// terminated early (e.g. by leaving the domain).
+class ftle_estimator
+{
+public:
+  explicit ftle_estimator  (domain_partitioner* partitioner, const vector3& spacing, const vector3& stride, const std::optional<aabb3>& aabb = std::nullopt);
+  ftle_estimator           (const ftle_estimator&  that) = delete ;
+  ftle_estimator           (      ftle_estimator&& temp) = default;
+ ~ftle_estimator           ()                            = default;
+  ftle_estimator& operator=(const ftle_estimator&  that) = delete ;
+  ftle_estimator& operator=(      ftle_estimator&& temp) = default;
+
+  // Collective. Seeds without a particle, without a particle on both sides along an axis or without integration time are NaN.
+  regular_scalar_field_3d estimate(const std::vector<particle<vector3, integer>>& particles) const;
+  // Collective. Writes the fields of all ranks as a single 3D float dataset, along with origin and spacing attributes, via parallel HDF5.
+  void                    save    (const regular_scalar_field_3d& ftle, const std::string& filepath, const std::string& dataset_name = "ftle") const;
+
+protected:
+  domain_partitioner* partitioner_     = nullptr;
+  vector3             grid_origin_     = {};
+  ivector3            grid_dimensions_ = {};
+  vector3             grid_spacing_    = {};
+};
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DPA_STAGES_IMPORTANCE_SEED_GENERATOR_HPP
+#define DPA_STAGES_IMPORTANCE_SEED_GENERATOR_HPP
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/particle.hpp>
+#include <dpa/types/regular_fields.hpp>
+
+namespace dpa
+{
+// Draws seeds in the cells of the vector field with a probability proportional to a density, e.g. the velocity or vorticity
+// magnitude, so that few seeds are spent on uninteresting regions. Each rank draws the same count within its own block,
+// which keeps the seed counts balanced. Reproducible for a given seed and process index, independent of the thread count.
+class importance_seed_generator
+{
+public:
+  // Non-negative density of the cell whose lower corner is at the given index of the vector field.
+  using density_function = std::function<scalar(const regular_vector_field_3d& vector_field, const ivector3& index)>;
+
+  static scalar                                  velocity_magnitude (const regular_vector_field_3d& vector_field, const ivector3& index);
+  static scalar                                  vorticity_magnitude(const regular_vector_field_3d& vector_field, const ivector3& index);
+  // Either "velocity_magnitude" (default) or "vorticity_magnitude".
+  static density_function                        density            (const std::string& name);
+
+  static std::vector<particle<vector3, integer>> generate           (const regular_vector_field_3d& vector_field, vector3 offset, vector3 size, integer count, integer iterations, integer process_index, const density_function& density, std::optional<aabb3> aabb = std::nullopt, std::uint32_t seed = 0);
+};
+}
+
+#endif
@@ -1,11 +1,19 @@
 #ifndef DPA_STAGES_INTEGRAL_CURVE_SAVER_HPP
 #define DPA_STAGES_INTEGRAL_CURVE_SAVER_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <variant>
+#include <vector>
 
 #include <hdf5.h>
 
 #include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/stages/integral_curve_spiller.hpp>
+#include <dpa/types/basic_types.hpp>
 #include <dpa/types/integral_curves.hpp>
 
 namespace dpa
@@ -13,19 +21,51 @@ namespace dpa
 class integral_curve_saver
 {
 public:
-  explicit integral_curve_saver  (domain_partitioner* partitioner, const std::string& filepath);
+  enum class topology
+  {
+    segments, // Two indices per segment (XDMF Polyline with two nodes per element).
+    mixed   , // Polyline type, vertex count and vertex indices per curve (XDMF Mixed).
+    offsets   // Curve offsets only, as in VTK. Not described by XDMF.
+  };
+  enum class vertex_encoding
+  {
+    raw            , // 32-bit float triplets.
+    quantized_delta  // See curve_codec. Stored with the curve offsets and the origin and precision attributes required for decoding.
+  };
+
+  explicit integral_curve_saver  (domain_partitioner* partitioner, const std::string& filepath, const std::string& topology = "segments", const std::string& vertex_encoding = "raw", const vector3& origin = vector3::Zero(), const scalar precision = scalar(1e-4));
   integral_curve_saver           (const integral_curve_saver&  that) = delete ;
   integral_curve_saver           (      integral_curve_saver&& temp) = default;
  ~integral_curve_saver           ();
   integral_curve_saver& operator=(const integral_curve_saver&  that) = delete ;
   integral_curve_saver& operator=(      integral_curve_saver&& temp) = default;
 
-  void save_integral_curves(const integral_curves_3d& integral_curves, bool use_64_bit_indices);
+  // The spilled rounds, if any, are loaded back one at a time, each once the previously loaded one is written.
+  void save_integral_curves(const integral_curves_3d& integral_curves, const integral_curve_spiller* spiller = nullptr);
 
 protected:
-  domain_partitioner* partitioner_ = {};
-  std::string         filepath_    = {};
-  hid_t               file_        = {};
+  // The buffers derived from a round, prepared in parallel and written by the HDF5 thread.
+  struct prepared_round
+  {
+    std::size_t                                                          index            = 0;
+    const compressed_integral_curves<vector3>*                           curves           = nullptr;
+    std::shared_ptr<const compressed_integral_curves<vector3>>           loaded_curves    {}; // Owns the curves of a spilled round.
+    std::vector<std::array<std::uint8_t, 3>>                             colors           {};
+    std::variant<std::vector<std::uint32_t>, std::vector<std::uint64_t>> indices          {};
+    std::vector<std::uint8_t>                                            encoded_vertices {};
+    std::string                                                          xdmf             {};
+  };
+
+  prepared_round      prepare_round(const compressed_integral_curves<vector3>& curves, std::size_t index) const;
+  void                write_round  (const prepared_round& round);
+
+  domain_partitioner* partitioner_     = {};
+  std::string         filepath_        = {};
+  hid_t               file_            = {};
+  topology            topology_        = topology::segments;
+  vertex_encoding     vertex_encoding_ = vertex_encoding::raw;
+  vector3             origin_          = {};
+  scalar              precision_       = {};
 };
 }
 
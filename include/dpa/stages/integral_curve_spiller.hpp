@@ -0,0 +1,58 @@
+#ifndef DPA_STAGES_INTEGRAL_CURVE_SPILLER_HPP
+#define DPA_STAGES_INTEGRAL_CURVE_SPILLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/integral_curves.hpp>
+
+namespace dpa
+{
+// Spills the integral curves of completed rounds to a local file per rank (e.g. on a tmpfs or NVMe scratch directory) once they
+// exceed a memory threshold, releasing their memory. A spilled round remains in the integral curves as an empty entry and is
+// loaded back on demand, one round at a time, e.g. by the integral_curve_saver. The file is raw and removed on destruction.
+// Should a write fail, the rounds stay in memory and the spilling is disabled.
+class integral_curve_spiller
+{
+public:
+  static std::size_t memory(const compressed_integral_curves<vector3>& curves);
+  static std::size_t memory(const integral_curves_3d&                  integral_curves);
+
+  // The threshold is in bytes per rank.
+  explicit integral_curve_spiller  (domain_partitioner* partitioner, const std::string& directory, const std::string& filepath, const std::size_t threshold);
+  integral_curve_spiller           (const integral_curve_spiller&  that) = delete ;
+  integral_curve_spiller           (      integral_curve_spiller&& temp) = default;
+ ~integral_curve_spiller           ();
+  integral_curve_spiller& operator=(const integral_curve_spiller&  that) = delete ;
+  integral_curve_spiller& operator=(      integral_curve_spiller&& temp) = default;
+
+  // Spills all rounds held in memory if they exceed the threshold. Returns the number of bytes released.
+  std::size_t                         spill  (integral_curves_3d& integral_curves);
+  bool                                spilled(std::size_t round) const;
+  // Thread-safe. Throws a std::runtime_error should the read fail or fall short.
+  compressed_integral_curves<vector3> load   (std::size_t round) const;
+
+  std::size_t                         spilled_memory() const;
+
+protected:
+  struct entry
+  {
+    std::uint64_t position     = 0;
+    std::uint64_t vertex_count = 0;
+    std::uint64_t offset_count = 0;
+  };
+
+  domain_partitioner* partitioner_ = nullptr;
+  std::string         filepath_    = {};
+  std::size_t         threshold_   = 0;
+  std::vector<entry>  entries_     = {}; // Per round. Empty entries (offset_count 0) are not spilled.
+  std::uint64_t       size_        = 0; // Of the file.
+  bool                failed_      = false;
+};
+}
+
+#endif
@@ -3,17 +3,26 @@
 
 #include <cstddef>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include <mpi.h>
 #include <tbb/concurrent_hash_map.h>
+#include <tbb/concurrent_queue.h>
+#include <tbb/concurrent_vector.h>
+#include <tbb/enumerable_thread_specific.h>
 
+#include <dpa/benchmark/advection_counters.hpp>
+#include <dpa/math/curve_decimator.hpp>
 #include <dpa/stages/domain_partitioner.hpp>
 #include <dpa/types/basic_types.hpp>
 #include <dpa/types/integral_curves.hpp>
 #include <dpa/types/integrators.hpp>
 #include <dpa/types/particle.hpp>
 #include <dpa/types/regular_fields.hpp>
+#include <dpa/types/termination_criteria.hpp>
+#include <dpa/utility/numa_domains.hpp>
 
 namespace dpa
 {
@@ -29,14 +38,21 @@ public:
     diffuse_lesser_average,
     diffuse_greater_limited_lesser_average
   };
+  // Picks the particles of a round and the order in which they are dispatched to the threads.
+  enum class scheduling
+  {
+    lifo                   , // The latest arrivals, in any order.
+    fifo                   , // The earliest arrivals, in any order.
+    longest_remaining_first, // The particles with the most remaining iterations, longest first. May starve the others.
+    age_priority             // The earliest arrivals, longest first.
+  };
 
   struct round_info
   {
     using particle_map = tbb::concurrent_hash_map<relative_direction, std::vector<particle<vector3, integer>>>;
 
     std::size_t  particle_count                        = 0;
-    std::size_t  curve_stride                          = 0;
-    std::size_t  vertex_count                          = 0;
+    std::size_t  particle_steps                        = 0; // Integration steps taken by the particles of the round. Set by advect.
     particle_map out_of_bounds_particles               {};
     particle_map load_balanced_out_of_bounds_particles {};
   };
@@ -64,13 +80,18 @@ public:
 
     std::size_t quota;
   };
+  struct handoff
+  {
+    std::vector<particle<vector3, integer>> particles {};
+    MPI_Request                             request   = MPI_REQUEST_NULL;
+  };
   struct output
   {
     std::vector<particle<vector3, integer>> particles       {};
     integral_curves_3d                      integral_curves {};
   };
 
-  explicit particle_advector  (domain_partitioner* partitioner, const integer particles_per_round, const std::string& load_balancer, const std::string& integrator, const scalar step_size, const bool gather_particles, const bool record);
+  explicit particle_advector  (domain_partitioner* partitioner, const integer particles_per_round, const std::string& load_balancer, const std::string& integrator, const scalar step_size, const bool gather_particles, const bool record, const curve_decimator<vector3>& decimator = curve_decimator<vector3>(), const termination_criteria& termination = termination_criteria(), const integer handoff_batch_size = 0, const std::string& scheduling = "lifo", const std::size_t round_memory_budget = 0);
   particle_advector           (const particle_advector&  that) = delete ;
   particle_advector           (      particle_advector&& temp) = default;
  ~particle_advector           ()                               = default;
@@ -84,21 +105,61 @@ protected:
 
   bool               check_completion        (                                                                                      const std::vector<particle<vector3, integer>>& active_particles);
   void               load_balance_distribute (                                                                                            std::vector<particle<vector3, integer>>& active_particles);
-  round_info         compute_round_info      (                                                                                      const std::vector<particle<vector3, integer>>& active_particles);
+  round_info         compute_round_info      (                                                                                            std::vector<particle<vector3, integer>>& active_particles);
   void               allocate_integral_curves(                                                                                                                                                                                                                    integral_curves_3d& integral_curves, const round_info& round_info);
   void               advect                  (const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields,       std::vector<particle<vector3, integer>>& active_particles, std::vector<particle<vector3, integer>>& inactive_particles, integral_curves_3d& integral_curves,       round_info& round_info);
   void               load_balance_collect    (const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields,                                                                  std::vector<particle<vector3, integer>>& inactive_particles,                                            round_info& round_info);
   void               out_of_bounds_distribute(                                                                                            std::vector<particle<vector3, integer>>& active_particles,                                                                                                   const round_info& round_info);
   void               gather_particles        (                                                                                                                                                       std::vector<particle<vector3, integer>>& inactive_particles);
-  void               prune_integral_curves   (                                                                                                                                                                                                                    integral_curves_3d& integral_curves);
+
+  void               send_handoff            (relative_direction direction, std::vector<particle<vector3, integer>>&& particles);
+  void               receive_handoffs        (std::size_t end_markers);
+
+  // Orders the particles of the round by the arena of the node of the pages of their cells. Returns the bounds of the range per arena.
+  std::vector<std::size_t>      bin_by_node(const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields, std::vector<particle<vector3, integer>>& active_particles, const round_info& round_info);
+  const numa_domains::page_map& page_map   (const regular_vector_field_3d& vector_field);
+
+  // Distinct from the tags of the exchanges between the rounds.
+  static constexpr int handoff_tag = 16;
 
   domain_partitioner*        partitioner_         {};
   integer                    particles_per_round_ {};
   load_balancer              load_balancer_       {};
+  scheduling                 scheduling_          {};
   variant_vector3_integrator integrator_          {};
   scalar                     step_size_           {};
   bool                       gather_particles_    {};
   bool                       record_              {};
+  curve_decimator<vector3>   decimator_           {};
+  termination_criteria       termination_         {};
+  integer                    handoff_batch_size_  {};
+  // Bytes per rank for the curves of a round, which limit the particles of the round by their maximum curve size. 0 is unlimited.
+  std::size_t                round_memory_budget_ {};
+
+  // Terminated particles per reason, accumulated over the rounds.
+  termination_criteria::counts termination_counts_ {};
+
+  // Streaming handoff (handoff_batch_size_ > 0, requires MPI_THREAD_MULTIPLE). The workers send each full batch of out of bounds
+  // particles as soon as it fills up, while a progress thread receives the batches of the neighbors into the inbound queue until each
+  // neighbor has sent its end marker (an empty batch) in out_of_bounds_distribute. The received particles join the next round.
+  tbb::concurrent_vector<handoff>                                   handoff_sends_     {};
+  tbb::concurrent_queue<std::vector<particle<vector3, integer>>>    inbound_particles_ {};
+  std::thread                                                       handoff_receiver_  {};
+
+  // Per-thread decimators, reset by begin() per particle instead of copied.
+  tbb::enumerable_thread_specific<curve_decimator<vector3>> decimators_ {};
+
+  // Per-thread append-only vertex chunks, compacted into the round's integral curves at the end of advect. Retained across rounds to reuse their capacity.
+  tbb::enumerable_thread_specific<std::vector<vector3>> vertex_chunks_ {};
+
+  // The nodes of the pages of each vector field, for the binning of the particles by node and the remote interpolations.
+  std::unordered_map<const regular_vector_field_3d*, numa_domains::page_map> page_maps_ {};
+
+#ifdef DPA_COUNTER_SUPPORT
+  // Per-thread hot path counters, combined into one entry of round_counters_ per call to advect.
+  tbb::enumerable_thread_specific<advection_counters>   counters_       {};
+  std::vector<advection_counters>                       round_counters_ {};
+#endif
 };
 }
 
@@ -0,0 +1,78 @@
+#ifndef DPA_STAGES_PARTICLE_CHECKPOINTER_HPP
+#define DPA_STAGES_PARTICLE_CHECKPOINTER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/particle.hpp>
+
+namespace dpa
+{
+// Periodic checkpoints of the in-flight particle state between rounds. Each rank writes its active and inactive particles and
+// the round counter as one raw binary blob, asynchronously, alternating between two files so that the previous checkpoint stays
+// intact while the next is written. The blob is only valid for the build and rank count that wrote it. Recorded curves are not
+// checkpointed; a restarted run records the remaining rounds only.
+class particle_checkpointer
+{
+public:
+  struct state
+  {
+    integer                                 round              = 0; // Number of completed rounds.
+    std::vector<particle<vector3, integer>> active_particles   {};
+    std::vector<particle<vector3, integer>> inactive_particles {};
+  };
+
+  // A checkpoint is due every round_interval rounds and/or every time_interval seconds (as measured on rank 0). Zero disables either.
+  explicit particle_checkpointer  (domain_partitioner* partitioner, const std::string& filepath, const integer round_interval, const scalar time_interval = scalar(0));
+  particle_checkpointer           (const particle_checkpointer&  that) = delete ;
+  particle_checkpointer           (      particle_checkpointer&& temp) = default;
+ ~particle_checkpointer           ();
+  particle_checkpointer& operator=(const particle_checkpointer&  that) = delete ;
+  particle_checkpointer& operator=(      particle_checkpointer&& temp) = default;
+
+  // Collective. Returns whether a checkpoint of the given number of completed rounds is due.
+  bool                 due   (const integer round);
+  // Collective. Copies the state and writes it in the background, once the previous checkpoint is complete on all ranks.
+  void                 save  (const integer round, const std::vector<particle<vector3, integer>>& active_particles, const std::vector<particle<vector3, integer>>& inactive_particles);
+  // Collective. Returns the newest checkpoint which is complete on all ranks, if any.
+  std::optional<state> load  ();
+  // Collective. Removes both checkpoints once the run is complete on all ranks.
+  void                 remove();
+
+protected:
+  struct header
+  {
+    std::uint64_t magic              = 0;
+    std::uint64_t particle_size      = 0;
+    std::int32_t  rank               = 0;
+    std::int32_t  size               = 0;
+    std::int32_t  round              = 0;
+    std::uint64_t active_count       = 0;
+    std::uint64_t inactive_count     = 0;
+  };
+
+  static constexpr std::uint64_t magic  = 0x44504143484b5054; // "DPACHKPT"
+  static constexpr std::uint64_t footer = 0x54504b4843415044; // The reverse, written last to mark the blob complete.
+
+  std::string          slot_filepath(std::size_t slot) const;
+  std::optional<state> read         (std::size_t slot) const;
+  void                 wait         ();
+
+  domain_partitioner*                   partitioner_    = nullptr;
+  std::string                           filepath_       = {};
+  integer                               round_interval_ = 0;
+  scalar                                time_interval_  = 0;
+  std::chrono::steady_clock::time_point last_time_      = {};
+  std::size_t                           next_slot_      = 0;
+  std::future<void>                     pending_        = {};
+};
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef DPA_STAGES_ROUND_TUNER_HPP
+#define DPA_STAGES_ROUND_TUNER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+
+namespace dpa
+{
+// Adapts the particles per round across the rounds. After each round, the slowest rank's advection time per particle and
+// communication time (the remaining stages of the round) predict the quota which meets the target round time, and the largest
+// curve memory per particle along with the smallest memory headroom predict the quota which fits the memory budget. The quota
+// moves halfway towards the smaller of the two, by at most a factor of two per round, yet never beyond the memory quota. The quota
+// never falls below a sixteenth of the initial particles per round, such that an exhausted budget does not stall the rounds.
+// The measurements are reduced over the ranks, hence all ranks decide the same quota.
+class round_tuner
+{
+public:
+  struct measurement
+  {
+    std::size_t particle_count     = 0; // Advected in the round.
+    double      advection_time     = 0; // Milliseconds.
+    double      communication_time = 0; // Milliseconds.
+    std::size_t round_memory       = 0; // Bytes of the curves recorded in the round.
+    std::size_t memory             = 0; // Bytes of the curves and particles retained after the round.
+  };
+  struct decision
+  {
+    static std::string csv_header();
+    std::string        to_string () const;
+
+    integer     round              = 0;
+    std::size_t particle_count     = 0; // Maximum over the ranks.
+    double      advection_time     = 0; // Maximum over the ranks.
+    double      communication_time = 0; // Maximum over the ranks.
+    double      particle_time      = 0; // Maximum over the ranks of the advection time per particle.
+    double      particle_memory    = 0; // Maximum over the ranks of the curve bytes per particle.
+    double      headroom           = 0; // Minimum over the ranks of the memory budget minus the retained memory.
+    integer     time_quota         = 0;
+    integer     memory_quota       = 0;
+    integer     quota              = 0;
+    std::string limit              = {}; // Either "time", "memory", "communication" (exceeding the target alone), "step" (the growth limit) or "none".
+  };
+
+  // The target round time is in seconds, the memory budget in megabytes per rank. Without a budget, the memory is not limited.
+  explicit round_tuner  (domain_partitioner* partitioner, const integer particles_per_round, const scalar target_round_time, const std::optional<scalar>& memory_budget = std::nullopt);
+  round_tuner           (const round_tuner&  that) = delete ;
+  round_tuner           (      round_tuner&& temp) = default;
+ ~round_tuner           ()                         = default;
+  round_tuner& operator=(const round_tuner&  that) = delete ;
+  round_tuner& operator=(      round_tuner&& temp) = default;
+
+  // Collective. Returns the particles per round of the next round.
+  integer                      update   (const measurement& measurement);
+
+  integer                      quota    () const;
+  const std::vector<decision>& decisions() const;
+
+protected:
+  static constexpr double gain        = 0.5 ;
+  static constexpr double growth      = 2.0 ;
+  static constexpr double shrinkage   = 16.0; // The minimum quota is the initial particles per round over this value.
+
+  domain_partitioner*   partitioner_       = nullptr;
+  integer               quota_             = 0;
+  integer               minimum_quota_     = 1;
+  double                target_round_time_ = 0; // Milliseconds.
+  std::optional<double> memory_budget_     = {}; // Bytes.
+  std::vector<decision> decisions_         = {};
+  bool                  exhausted_         = false;
+};
+}
+
+#endif
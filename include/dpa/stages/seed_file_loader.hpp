@@ -0,0 +1,44 @@
+#ifndef DPA_STAGES_SEED_FILE_LOADER_HPP
+#define DPA_STAGES_SEED_FILE_LOADER_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/particle.hpp>
+
+namespace dpa
+{
+// Loads explicit seed positions, either from a 2D Nx3 float HDF5 dataset or, without a dataset name, from a raw file of float triplets.
+// Each rank reads a contiguous slice of the seeds and bins them by owning block, after which one all to all exchange delivers them.
+// Seeds outside the domain (or the boundaries, if any) are discarded.
+class seed_file_loader
+{
+public:
+  explicit seed_file_loader  (domain_partitioner* partitioner, const std::string& filepath, const std::optional<std::string>& dataset_path = std::nullopt);
+  seed_file_loader           (const seed_file_loader&  that) = delete ;
+  seed_file_loader           (      seed_file_loader&& temp) = default;
+ ~seed_file_loader           ()                              = default;
+  seed_file_loader& operator=(const seed_file_loader&  that) = delete ;
+  seed_file_loader& operator=(      seed_file_loader&& temp) = default;
+
+  // Collective.
+  std::vector<particle<vector3, integer>> load(const vector3& spacing, integer iterations, std::optional<aabb3> aabb = std::nullopt);
+
+protected:
+  std::pair<std::size_t, std::size_t>     slice    (std::size_t count) const;
+  std::vector<vector3>                    read_hdf5() const;
+  std::vector<vector3>                    read_raw () const;
+  std::vector<vector3>                    exchange (const std::vector<vector3>& positions, const vector3& spacing, const std::optional<aabb3>& aabb) const;
+
+  domain_partitioner*        partitioner_  = nullptr;
+  std::string                filepath_     = {};
+  std::optional<std::string> dataset_path_ = {};
+};
+}
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef DPA_STAGES_UNIFORM_SEED_GENERATOR_HPP
 #define DPA_STAGES_UNIFORM_SEED_GENERATOR_HPP
 
+#include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include <dpa/types/basic_types.hpp>
@@ -12,12 +14,14 @@ namespace dpa
 class uniform_seed_generator
 {
 public:
+  // The origin and the dimensions of the seed grid of generate.
+  static std::pair<vector3, ivector3>            grid           (vector3 offset, vector3 size, vector3  stride,                                         std::optional<aabb3> aabb = std::nullopt);
   static std::vector<particle<vector3, integer>> generate       (vector3 offset, vector3 size, vector3  stride, integer iterations, integer process_index, std::optional<aabb3> aabb = std::nullopt);
-  static std::vector<particle<vector3, integer>> generate_random(vector3 offset, vector3 size, integer  count , integer iterations, integer process_index, std::optional<aabb3> aabb = std::nullopt);
-  static std::vector<particle<vector3, integer>> generate_random(vector3 offset, vector3 size, ivector2 range , integer iterations, integer process_index, std::optional<aabb3> aabb = std::nullopt);
+  // Reproducible for a given seed and process index, independent of the thread count (see philox).
+  static std::vector<particle<vector3, integer>> generate_random(vector3 offset, vector3 size, integer  count , integer iterations, integer process_index, std::optional<aabb3> aabb = std::nullopt, std::uint32_t seed = 0);
+  static std::vector<particle<vector3, integer>> generate_random(vector3 offset, vector3 size, ivector2 range , integer iterations, integer process_index, std::optional<aabb3> aabb = std::nullopt, std::uint32_t seed = 0);
 
   // TODO: Seeds from radius, generated within the sphere enclosed by it.
-  // TODO: Seeds from vector of particles     (read in parallel, then distributed all to all, also from file of 1D vector3 array).
   // TODO: Seeds from scalar mask of booleans (read in parallel, one particle per true voxel, also from file of 3D boolean array).
 };
 }
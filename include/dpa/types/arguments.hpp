@@ -10,21 +10,58 @@ namespace dpa
 {
 struct arguments
 {
-  std::string             input_dataset_filepath               ;
-  std::string             input_dataset_name                   ;
-  std::string             input_dataset_spacing_name           ;
-  std::optional<vector3>  seed_generation_stride               ; // Existence implies deterministic seed generation.
-  std::optional<integer>  seed_generation_count                ; // Existence implies random seed generation.
-  std::optional<ivector2> seed_generation_range                ; // Existence implies random seed count and generation.
-  integer                 seed_generation_iterations           ;
-  std::optional<aabb3>    seed_generation_boundaries           ;
-  integer                 particle_advector_particles_per_round;
-  std::string             particle_advector_load_balancer      ;
-  std::string             particle_advector_integrator         ;
-  scalar                  particle_advector_step_size          ;
-  bool                    particle_advector_gather_particles   ;
-  bool                    particle_advector_record             ;
-  std::string             output_dataset_filepath              ;
+  std::string                input_dataset_filepath               ;
+  std::string                input_dataset_name                   ;
+  std::string                input_dataset_spacing_name           ;
+  std::optional<std::string> input_analytic_field                 ; // Existence implies an analytic field instead of the dataset. Either "abc", "double_gyre", "rankine_vortex" or "uniform".
+  std::optional<ivector3>    input_analytic_field_dimensions      ; // Required with the analytic field.
+  std::optional<vector3>     input_analytic_field_spacing         ; // Defaults to sampling the natural extent of the analytic field.
+  std::optional<std::string> seed_generation_filepath             ; // Existence implies seeds from file, read in parallel and routed to their owning ranks.
+  std::optional<std::string> seed_generation_dataset_name         ; // A 2D Nx3 float dataset of the seed file. Without it, the file is read as raw float triplets.
+  std::optional<vector3>     seed_generation_stride               ; // Existence implies deterministic seed generation.
+  std::optional<integer>     seed_generation_count                ; // Existence implies random seed generation.
+  std::optional<ivector2>    seed_generation_range                ; // Existence implies random seed count and generation.
+  std::optional<std::string> seed_generation_importance           ; // With the seed count, draws the seeds proportional to either "velocity_magnitude" or "vorticity_magnitude" instead of uniformly.
+  std::optional<integer>     seed_generation_seed                 ; // Seed of the random seed generation. Defaults to 0.
+  integer                    seed_generation_iterations           ;
+  std::optional<aabb3>       seed_generation_boundaries           ;
+  integer                    particle_advector_particles_per_round;
+  std::string                particle_advector_load_balancer      ;
+  std::string                particle_advector_integrator         ;
+  scalar                     particle_advector_step_size          ;
+  bool                       particle_advector_gather_particles   ;
+  bool                       particle_advector_record             ;
+  std::optional<integer>     particle_advector_record_stride      ; // Records every n-th step. Defaults to 1, or with the spacing or tolerance to none (the first and last step, besides the spacing and tolerance), in which case the tolerance records at least every 65th step (see curve_decimator::default_window).
+  std::optional<scalar>      particle_advector_record_spacing     ; // Records a vertex whenever the arc length since the last one reaches this value.
+  std::optional<scalar>      particle_advector_record_tolerance   ; // Skips vertices deviating less than this value from the curve recorded so far.
+  std::optional<integer>     particle_advector_handoff_batch_size ; // Sends out of bounds particles to the neighbors in batches of this size during the advection, from the worker threads. Requires MPI_THREAD_MULTIPLE. Disabled by default.
+  std::optional<std::string> particle_advector_scheduling         ; // Either "lifo" (default), "fifo", "longest_remaining_first" or "age_priority". See particle_advector::scheduling.
+  std::optional<scalar>      particle_advector_tuner_round_time   ; // Existence implies adapting the particles per round (starting from particle_advector_particles_per_round) towards rounds of this many seconds. See round_tuner.
+  std::optional<scalar>      particle_advector_memory_budget      ; // Megabytes per rank for the recorded curves. Half limits the particles of a round by their maximum curve size, half the curves retained in memory, beyond which they are spilled to disk (except in the warm benchmark mode). The tuner limits the particles per round to the whole.
+  std::optional<std::string> particle_advector_spill_directory    ; // The directory of the spilled curves, [OUTPUT].rank_[RANK].spill, e.g. a local scratch or tmpfs. Defaults to the directory of the output.
+  std::string                output_dataset_filepath              ;
+  std::optional<scalar>      termination_minimum_speed            ; // Terminates particles slower than this value. Particles are always terminated at zero velocity.
+  std::optional<scalar>      termination_maximum_arc_length       ;
+  std::optional<scalar>      termination_maximum_time             ; // Integration time, i.e. the step count times the step size.
+  std::optional<aabb3>       termination_region                   ; // Terminates particles leaving this region.
+  std::optional<integer>     termination_stagnation_window        ; // Terminates particles moving less than termination_stagnation_distance over this many steps.
+  std::optional<scalar>      termination_stagnation_distance      ; // Defaults to 0.
+  std::optional<std::string> output_topology                      ; // Either "segments" (default), "mixed" or "offsets".
+  std::optional<std::string> output_vertex_encoding               ; // Either "raw" (default) or "quantized_delta".
+  std::optional<scalar>      output_vertex_precision              ; // Quantization step of the "quantized_delta" encoding. Defaults to 1e-4.
+  std::optional<bool>        output_ftle                          ; // Writes the FTLE field on the seed grid to [OUTPUT].ftle.h5. Requires the seed_generation_stride, particle_advector_gather_particles and DPA_FTLE_SUPPORT.
+  std::optional<integer>     thread_count                         ; // Limits the number of threads per rank. Defaults to all hardware threads.
+  std::optional<bool>        thread_pinning                       ; // Pins the threads of the rank to the CPUs of its affinity mask (e.g. as bound by mpiexec) round robin.
+  std::optional<bool>        thread_numa_arenas                   ; // Splits the field initialization and the advection into one contiguous range per NUMA node, each in an arena constrained to that node. The particles of each round are binned by the node of the field pages of their cells.
+  std::optional<std::string> benchmark_mode                       ; // Either "cold" (default), repeating the whole pipeline, or "warm", loading once and repeating the seed generation and advection without saving.
+  std::optional<integer>     benchmark_iterations                 ; // Defaults to 10.
+  std::optional<integer>     benchmark_warmup_iterations          ; // Precede the iterations and are excluded from the statistics. Defaults to 0.
+  std::optional<integer>     checkpoint_rounds                    ; // Checkpoints the particles every n rounds to [OUTPUT].rank_[RANK].checkpoint_[0|1].
+  std::optional<scalar>      checkpoint_seconds                   ; // Checkpoints the particles every n seconds (measured on rank 0).
+  std::optional<bool>        checkpoint_restart                   ; // Resumes the rounds from the newest checkpoint complete on all ranks, if any. Requires the checkpoint_rounds and/or checkpoint_seconds.
+  std::optional<std::string> log_level                            ; // Either "trace", "debug" (stage and handoff messages of each rank), "info" (default), "warning", "error" or "off".
+  std::optional<integer>     log_rate_limit                       ; // Messages below warning level per second per rank. 0 is unlimited. Defaults to 100.
+  std::optional<bool>        log_aggregate                        ; // Logs the minimum, mean and maximum over the ranks of the particles and steps per round on rank 0. Collective.
 };
 }
 
@@ -1,15 +1,38 @@
 #ifndef DPA_TYPES_INTEGRAL_CURVES_HPP
 #define DPA_TYPES_INTEGRAL_CURVES_HPP
 
+#include <cstddef>
 #include <vector>
 
 #include <dpa/types/basic_types.hpp>
 
 namespace dpa
 {
-using integral_curves_2d = std::vector<std::vector<vector2>>;
-using integral_curves_3d = std::vector<std::vector<vector3>>;
-using integral_curves_4d = std::vector<std::vector<vector4>>;
+// Compressed sparse row storage of the integral curves of a round. Curve i spans the vertices [offsets[i], offsets[i + 1]).
+template <typename vertex_type>
+struct compressed_integral_curves
+{
+  std::size_t curve_count () const
+  {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+  }
+  std::size_t curve_size  (const std::size_t index) const
+  {
+    return offsets[index + 1] - offsets[index];
+  }
+  std::size_t vertex_count() const
+  {
+    return vertices.size();
+  }
+
+  std::vector<vertex_type> vertices {};
+  std::vector<std::size_t> offsets  {};
+};
+
+// One compressed_integral_curves per round.
+using integral_curves_2d = std::vector<compressed_integral_curves<vector2>>;
+using integral_curves_3d = std::vector<compressed_integral_curves<vector3>>;
+using integral_curves_4d = std::vector<compressed_integral_curves<vector4>>;
 }
 
 #endif
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define DPA_TYPES_PARTICLE_HPP
 
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 #include <dpa/types/relative_direction.hpp>
 
@@ -11,6 +13,21 @@ namespace dpa
 template <typename position_type, typename integer_type>
 struct particle
 {
+  using scalar_type = std::decay_t<decltype(std::declval<position_type>()[0])>;
+
+  particle          () = default;
+  // A seed. The rank is only retained with FTLE support.
+  explicit particle (const position_type& seed_position, const integer_type iterations, const integer_type rank = 0)
+  : position            (seed_position)
+  , remaining_iterations(iterations   )
+#ifdef DPA_FTLE_SUPPORT
+  , original_rank       (rank         )
+  , original_position   (seed_position)
+#endif
+  {
+
+  }
+
   // Function for boost::serialization which is used by boost::mpi.
   template<class archive_type>
   void serialize(archive_type& archive, const std::uint32_t version)
@@ -27,6 +44,9 @@ struct particle
     archive & original_position[1];
     archive & original_position[2];
 #endif
+
+    archive & time;
+    archive & arc_length;
   }
 
   position_type           position             = {};
@@ -37,6 +57,10 @@ struct particle
   integer_type       original_rank        = 0 ;
   position_type      original_position    = position;
 #endif
+
+  // Accumulated across rounds and ranks for the termination criteria.
+  scalar_type             time                 = 0 ;
+  scalar_type             arc_length           = 0 ;
 };
 }
 
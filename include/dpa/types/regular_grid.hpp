@@ -9,6 +9,7 @@
 
 #include <dpa/math/indexing.hpp>
 #include <dpa/math/permute_for.hpp>
+#include <dpa/utility/first_touch_allocator.hpp>
 
 namespace dpa
 {
@@ -17,6 +18,7 @@ struct regular_grid
 {
   using domain_type = typename vector_traits<scalar, dimensions>::type;
   using index_type  = std::array<std::size_t, dimensions>;
+  using array_type  = boost::multi_array<element_type, dimensions, first_touch_allocator<element_type>>;
 
   // Ducks [] on the domain_type.
   bool         contains   (const domain_type& position) const
@@ -55,10 +57,10 @@ struct regular_grid
     return intermediates[0];
   }
 
-  boost::multi_array<element_type, dimensions> data    {};
-  domain_type                                  offset  {};
-  domain_type                                  size    {};
-  domain_type                                  spacing {};
+  array_type  data    {};
+  domain_type offset  {};
+  domain_type size    {};
+  domain_type spacing {};
 };
 }
 
@@ -0,0 +1,40 @@
+#ifndef DPA_TYPES_TERMINATION_CRITERIA_HPP
+#define DPA_TYPES_TERMINATION_CRITERIA_HPP
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include <dpa/types/basic_types.hpp>
+
+namespace dpa
+{
+// Criteria terminating a particle before its remaining iterations are exhausted. Each is disabled when unset.
+struct termination_criteria
+{
+  enum class reason
+  {
+    iterations  , // The remaining iterations are exhausted.
+    domain      , // Left the domain of all ranks.
+    velocity    , // The velocity magnitude is zero or below the minimum speed.
+    arc_length  , // Reached the maximum arc length.
+    time        , // Reached the maximum time.
+    region      , // Left the region.
+    stagnation  , // Moved less than the stagnation distance over the stagnation window.
+    count
+  };
+  using counts = std::array<std::size_t, static_cast<std::size_t>(reason::count)>;
+
+  static constexpr std::array<const char*, static_cast<std::size_t>(reason::count)> names = 
+    {"iterations", "domain", "velocity", "arc_length", "time", "region", "stagnation"};
+
+  std::optional<scalar>  minimum_speed       {};
+  std::optional<scalar>  maximum_arc_length  {};
+  std::optional<scalar>  maximum_time        {};
+  std::optional<aabb3>   region              {};
+  std::optional<integer> stagnation_window   {}; // In steps. The window restarts whenever the particle changes rank.
+  scalar                 stagnation_distance = scalar(0);
+};
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef DPA_UTILITY_CURVE_CODEC_HPP
+#define DPA_UTILITY_CURVE_CODEC_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <tbb/tbb.h>
+
+#include <dpa/types/basic_types.hpp>
+#include <dpa/types/integral_curves.hpp>
+
+namespace dpa
+{
+// Compact encoding of the vertices of compressed_integral_curves:
+// - Each vertex is quantized relative to an origin (e.g. the block origin of the rank) to integer multiples of the precision.
+// - Each quantized vertex is replaced by its difference to the previous vertex of the same curve. The first vertex of a curve is stored as is.
+// - Each component of each difference is stored as a zigzag LEB128 varint, hence consecutive, correlated vertices take one or two bytes per component.
+// The maximum reconstruction error per component is precision / 2. The offsets of the curves are required for decoding and are not part of the stream.
+namespace curve_codec
+{
+inline std::uint64_t zigzag_encode(const std::int64_t  value)
+{
+  return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63);
+}
+inline std::int64_t  zigzag_decode(const std::uint64_t value)
+{
+  return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+}
+inline std::size_t   varint_size  (std::uint64_t value)
+{
+  std::size_t size = 1;
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+inline std::uint8_t* varint_write (std::uint64_t value, std::uint8_t* output)
+{
+  while (value >= 0x80)
+  {
+    *output++ = std::uint8_t(value | 0x80);
+    value >>= 7;
+  }
+  *output++ = std::uint8_t(value);
+  return output;
+}
+inline const std::uint8_t* varint_read(const std::uint8_t* input, std::uint64_t& value)
+{
+  value = 0;
+  for (std::size_t shift = 0; ; shift += 7)
+  {
+    const auto byte = *input++;
+    value |= std::uint64_t(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return input;
+  }
+}
+
+inline std::array<std::int64_t, 3> quantize(const vector3& vertex, const vector3& origin, const scalar precision)
+{
+  return
+  {
+    std::llround(double(vertex[0] - origin[0]) / precision),
+    std::llround(double(vertex[1] - origin[1]) / precision),
+    std::llround(double(vertex[2] - origin[2]) / precision)
+  };
+}
+
+// Encodes the curves in parallel; first sizing the stream of each curve, then writing them at their offsets.
+inline std::vector<std::uint8_t> encode(const compressed_integral_curves<vector3>& curves, const vector3& origin, const scalar precision)
+{
+  const auto curve_count = curves.curve_count();
+
+  const auto for_each_difference = [&] (const std::size_t curve_index, const auto& function)
+  {
+    std::array<std::int64_t, 3> previous {0, 0, 0};
+    for (auto vertex_index = curves.offsets[curve_index]; vertex_index < curves.offsets[curve_index + 1]; ++vertex_index)
+    {
+      const auto current = quantize(curves.vertices[vertex_index], origin, precision);
+      for (std::size_t i = 0; i < 3; ++i)
+        function(zigzag_encode(current[i] - previous[i]));
+      previous = current;
+    }
+  };
+
+  std::vector<std::size_t> byte_offsets(curve_count + 1, 0);
+  tbb::parallel_for(std::size_t(0), curve_count, std::size_t(1), [&] (const std::size_t curve_index)
+  {
+    for_each_difference(curve_index, [&] (const std::uint64_t value) { byte_offsets[curve_index + 1] += varint_size(value); });
+  });
+  std::partial_sum(byte_offsets.begin(), byte_offsets.end(), byte_offsets.begin());
+
+  std::vector<std::uint8_t> bytes(byte_offsets.back());
+  tbb::parallel_for(std::size_t(0), curve_count, std::size_t(1), [&] (const std::size_t curve_index)
+  {
+    auto output = bytes.data() + byte_offsets[curve_index];
+    for_each_difference(curve_index, [&] (const std::uint64_t value) { output = varint_write(value, output); });
+  });
+  return bytes;
+}
+// Reference decoder. Returns the vertices of the curves delimited by the offsets.
+inline std::vector<vector3>       decode(const std::vector<std::uint8_t>& bytes, const std::vector<std::size_t>& offsets, const vector3& origin, const scalar precision)
+{
+  std::vector<vector3> vertices(offsets.empty() ? 0 : offsets.back());
+
+  auto input = bytes.data();
+  for (std::size_t curve_index = 0; curve_index + 1 < offsets.size(); ++curve_index)
+  {
+    std::array<std::int64_t, 3> current {0, 0, 0};
+    for (auto vertex_index = offsets[curve_index]; vertex_index < offsets[curve_index + 1]; ++vertex_index)
+    {
+      for (std::size_t i = 0; i < 3; ++i)
+      {
+        std::uint64_t value;
+        input       = varint_read(input, value);
+        current[i] += zigzag_decode(value);
+        vertices[vertex_index][i] = scalar(double(origin[i]) + double(current[i]) * precision);
+      }
+    }
+  }
+  return vertices;
+}
+}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef DPA_UTILITY_FIRST_TOUCH_ALLOCATOR_HPP
+#define DPA_UTILITY_FIRST_TOUCH_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include <tbb/partitioner.h>
+
+#include <dpa/utility/numa_domains.hpp>
+
+namespace dpa
+{
+// Zeroes the allocated pages in parallel, in contiguous ranges per thread (see numa_domains::parallel_for), so that the operating
+// system places each page on the node of the thread touching it first rather than on the node of the allocating thread.
+template <typename type>
+class first_touch_allocator
+{
+public:
+  using value_type = type;
+
+  first_touch_allocator () = default;
+  template <typename other_type>
+  first_touch_allocator (const first_touch_allocator<other_type>& that) { }
+
+  type* allocate  (const std::size_t count)
+  {
+    const auto pointer   = std::allocator<type>().allocate(count);
+    const auto bytes     = reinterpret_cast<unsigned char*>(pointer);
+    const auto size      = count * sizeof(type);
+    const auto page_size = numa_domains::page_size();
+    numa_domains::instance().parallel_for((size + page_size - 1) / page_size, [&] (const std::size_t page)
+    {
+      std::memset(bytes + page * page_size, 0, std::min(page_size, size - page * page_size));
+    }, tbb::static_partitioner());
+    return pointer;
+  }
+  void  deallocate(type* pointer, const std::size_t count)
+  {
+    std::allocator<type>().deallocate(pointer, count);
+  }
+
+  template <typename other_type>
+  bool  operator==(const first_touch_allocator<other_type>& that) const { return true ; }
+  template <typename other_type>
+  bool  operator!=(const first_touch_allocator<other_type>& that) const { return false; }
+};
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef DPA_UTILITY_LOGGER_HPP
+#define DPA_UTILITY_LOGGER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <mpi.h>
+#include <tbb/concurrent_queue.h>
+
+namespace dpa
+{
+// Leveled, asynchronous logger. The messages are captured by value and formatted (prefixed by the level, rank and elapsed time)
+// on a background sink thread, hence logging costs a queue push on the calling thread. The messages below warning level are
+// rate limited per rank; the suppressed message count is reported along with the next admitted message.
+// Aggregation through reduce() replaces per-rank messages by a single rank-0 summary of the minimum, mean and maximum over the ranks
+// (and over the rounds, for per-round values).
+class logger
+{
+public:
+  enum class level
+  {
+    trace  ,
+    debug  ,
+    info   ,
+    warning,
+    error  ,
+    off
+  };
+
+  static logger& instance         ()
+  {
+    static logger singleton;
+    return singleton;
+  }
+  static level   parse_level      (const std::string& name)
+  {
+    if      (name == "trace"  ) return level::trace  ;
+    else if (name == "debug"  ) return level::debug  ;
+    else if (name == "warning") return level::warning;
+    else if (name == "error"  ) return level::error  ;
+    else if (name == "off"    ) return level::off    ;
+    return level::info;
+  }
+
+  logger           (const logger&  that) = delete;
+  logger           (      logger&& temp) = delete;
+ ~logger           ()
+  {
+    if (suppressed_ > 0)
+      queue_.push(entry {level::info, rank_, std::chrono::steady_clock::now(), suppressed_, [ ] (std::ostream& stream) { stream << "Logging stopped"; }});
+    queue_.push(entry());
+    sink_.join();
+  }
+  logger& operator=(const logger&  that) = delete;
+  logger& operator=(      logger&& temp) = delete;
+
+  // The aggregation is collective, hence must be configured identically on all ranks of the communicator.
+  void configure       (const level minimum_level, const std::size_t rate_limit, const bool aggregate, const MPI_Comm communicator = MPI_COMM_WORLD)
+  {
+    std::int32_t rank;
+    MPI_Comm_rank(communicator, &rank);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    minimum_level_ = minimum_level;
+    rate_limit_    = rate_limit   ;
+    aggregate_     = aggregate    ;
+    communicator_  = communicator ;
+    rank_          = rank         ;
+  }
+
+  bool enabled         (const level severity) const
+  {
+    return severity >= minimum_level_ && severity != level::off;
+  }
+  bool aggregates      () const
+  {
+    return aggregate_;
+  }
+
+  template <typename... types>
+  void log             (const level severity, const types... values)
+  {
+    if (!enabled(severity))
+      return;
+
+    std::size_t suppressed;
+    if (!admit(severity, suppressed))
+      return;
+
+    queue_.push(entry {severity, rank_, std::chrono::steady_clock::now(), suppressed, [=] (std::ostream& stream) { (stream << ... << values); }});
+  }
+  template <typename... types> void trace  (const types... values) { log(level::trace  , values...); }
+  template <typename... types> void debug  (const types... values) { log(level::debug  , values...); }
+  template <typename... types> void info   (const types... values) { log(level::info   , values...); }
+  template <typename... types> void warning(const types... values) { log(level::warning, values...); }
+  template <typename... types> void error  (const types... values) { log(level::error  , values...); }
+
+  // Collective when aggregating. Logs "<label>: min <..> mean <..> max <..>" over the ranks on rank 0. No-op unless aggregating at an enabled level.
+  void reduce          (const level severity, const std::string& label, const double value)
+  {
+    if (!aggregate_ || !enabled(severity))
+      return;
+
+    std::int32_t size;
+    MPI_Comm_size(communicator_, &size);
+
+    double minimum, maximum, sum;
+    MPI_Reduce(&value, &minimum, 1, MPI_DOUBLE, MPI_MIN, 0, communicator_);
+    MPI_Reduce(&value, &maximum, 1, MPI_DOUBLE, MPI_MAX, 0, communicator_);
+    MPI_Reduce(&value, &sum    , 1, MPI_DOUBLE, MPI_SUM, 0, communicator_);
+
+    if (rank_ == 0)
+      queue_.push(entry {severity, rank_, std::chrono::steady_clock::now(), 0, [=, mean = sum / size] (std::ostream& stream)
+      {
+        stream << label << ": min " << minimum << " mean " << mean << " max " << maximum;
+      }});
+  }
+  // As above, per round. Logs a single "<label>: rounds <..> total <..> min <..> mean <..> max <..>" summary over the rounds and
+  // ranks, and one "<label> <round>: min <..> mean <..> max <..>" line per round over the ranks at debug level. The round counts
+  // must match across ranks.
+  void reduce          (const level severity, const std::string& label, const std::vector<double>& values)
+  {
+    if (!aggregate_ || !enabled(severity))
+      return;
+
+    std::int32_t size;
+    MPI_Comm_size(communicator_, &size);
+
+    std::vector<double> minima(values.size()), maxima(values.size()), sums(values.size());
+    MPI_Reduce(values.data(), minima.data(), values.size(), MPI_DOUBLE, MPI_MIN, 0, communicator_);
+    MPI_Reduce(values.data(), maxima.data(), values.size(), MPI_DOUBLE, MPI_MAX, 0, communicator_);
+    MPI_Reduce(values.data(), sums  .data(), values.size(), MPI_DOUBLE, MPI_SUM, 0, communicator_);
+
+    if (rank_ != 0)
+      return;
+
+    const auto rounds  = values.size();
+    const auto total   = std::accumulate(sums.begin(), sums.end(), 0.0);
+    const auto minimum = rounds > 0 ? *std::min_element(minima.begin(), minima.end()) : 0.0;
+    const auto maximum = rounds > 0 ? *std::max_element(maxima.begin(), maxima.end()) : 0.0;
+    const auto mean    = rounds > 0 ? total / (double(rounds) * size)                  : 0.0;
+    queue_.push(entry {severity, rank_, std::chrono::steady_clock::now(), 0, [=] (std::ostream& stream)
+    {
+      stream << label << ": rounds " << rounds << " total " << total << " min " << minimum << " mean " << mean << " max " << maximum;
+    }});
+
+    if (enabled(level::debug))
+      for (std::size_t index = 0; index < rounds; ++index)
+        queue_.push(entry {level::debug, rank_, std::chrono::steady_clock::now(), 0, [=, minimum = minima[index], maximum = maxima[index], mean = sums[index] / size] (std::ostream& stream)
+        {
+          stream << label << " " << index << ": min " << minimum << " mean " << mean << " max " << maximum;
+        }});
+  }
+
+protected:
+  struct entry
+  {
+    level                                 severity   = level::off;
+    std::int32_t                          rank       = 0;
+    std::chrono::steady_clock::time_point time       = {};
+    std::size_t                           suppressed = 0;
+    std::function<void(std::ostream&)>    format     ; // Empty for the stop entry.
+  };
+
+  logger           ()
+  : epoch_(std::chrono::steady_clock::now()), sink_([this] () { sink(); })
+  {
+
+  }
+
+  bool admit           (const level severity, std::size_t& suppressed)
+  {
+    suppressed = 0;
+    if (severity >= level::warning || rate_limit_ == 0)
+      return true;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    if (now - window_start_ >= std::chrono::seconds(1))
+    {
+      window_start_ = now;
+      window_count_ = 0;
+    }
+    if (window_count_ >= rate_limit_)
+    {
+      ++suppressed_;
+      return false;
+    }
+    ++window_count_;
+    std::swap(suppressed, suppressed_);
+    return true;
+  }
+
+  void sink            ()
+  {
+    static constexpr const char* names[] = {"trace", "debug", "info", "warning", "error", "off"};
+
+    std::ostringstream stream;
+    while (true)
+    {
+      entry entry;
+      queue_.pop(entry);
+      if (!entry.format)
+        break;
+
+      stream.str(std::string());
+      stream << "[" << std::fixed << std::setprecision(3) << std::chrono::duration<double>(entry.time - epoch_).count() << "s]" << std::defaultfloat << std::setprecision(6);
+      stream << "[rank " << entry.rank << "][" << names[static_cast<std::size_t>(entry.severity)] << "] ";
+      entry.format(stream);
+      if (entry.suppressed > 0)
+        stream << " (" << entry.suppressed << " messages suppressed)";
+      stream << "\n";
+
+      auto& output = entry.severity >= level::warning ? std::cerr : std::cout;
+      output << stream.str();
+      if (queue_.empty())
+        output.flush();
+    }
+    std::cout.flush();
+  }
+
+  level                                     minimum_level_ = level::info;
+  std::size_t                               rate_limit_    = 0; // Messages per second per rank. 0 is unlimited.
+  bool                                      aggregate_     = false;
+  MPI_Comm                                  communicator_  = MPI_COMM_WORLD;
+  std::int32_t                              rank_          = 0;
+
+  std::mutex                                mutex_         ;
+  std::chrono::steady_clock::time_point     window_start_  = {};
+  std::size_t                               window_count_  = 0;
+  std::size_t                               suppressed_    = 0;
+
+  std::chrono::steady_clock::time_point     epoch_         ;
+  tbb::concurrent_bounded_queue<entry>      queue_         ;
+  std::thread                               sink_          ;
+};
+}
+
+#endif
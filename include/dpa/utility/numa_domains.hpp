@@ -0,0 +1,255 @@
+#ifndef DPA_UTILITY_NUMA_DOMAINS_HPP
+#define DPA_UTILITY_NUMA_DOMAINS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <tbb/task_scheduler_observer.h>
+
+#include <dpa/types/basic_types.hpp>
+
+namespace dpa
+{
+// NUMA placement of the threads and memory of a rank. Optionally pins the worker threads to the CPUs of the process affinity mask
+// (e.g. as bound by mpiexec) round robin, each once on its first entry, and optionally splits the parallel loops into one contiguous
+// range per NUMA node, each executed in an arena constrained to that node (requires TBB with hwloc support, otherwise the loops are
+// not split). first_touch_allocator touches memory through the same split, hence spreads the pages of a field over the nodes. The
+// particle_advector bins the particles of each round by the node of the pages of their cells into the ranges of the same nodes.
+// The node queries are Linux only and report no node (-1) elsewhere.
+class numa_domains
+{
+public:
+  // The nodes of the pages of a memory range.
+  struct page_map
+  {
+    integer node(const void* address) const
+    {
+      const auto index = (reinterpret_cast<std::uintptr_t>(address) - begin) / page_size;
+      return index < nodes.size() ? nodes[index] : -1;
+    }
+
+    std::uintptr_t       begin     = 0   ;
+    std::size_t          page_size = 4096;
+    std::vector<integer> nodes     {}    ;
+  };
+
+  static numa_domains& instance    ()
+  {
+    static numa_domains instance;
+    return instance;
+  }
+
+  static std::size_t   page_size   ()
+  {
+#ifdef __linux__
+    return std::size_t(sysconf(_SC_PAGESIZE));
+#else
+    return 4096;
+#endif
+  }
+  static integer       current_node()
+  {
+#ifdef __linux__
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+      return integer(node);
+#endif
+    return -1;
+  }
+  // Pages not yet touched report no node.
+  static page_map      map_pages   (const void* begin, const std::size_t bytes)
+  {
+    page_map map;
+    map.page_size = page_size();
+    map.begin     = reinterpret_cast<std::uintptr_t>(begin) / map.page_size * map.page_size;
+    map.nodes.resize((reinterpret_cast<std::uintptr_t>(begin) + bytes - map.begin + map.page_size - 1) / map.page_size, -1);
+#ifdef __linux__
+    std::vector<void*> pages(map.nodes.size());
+    for (std::size_t index = 0; index < pages.size(); ++index)
+      pages[index] = reinterpret_cast<void*>(map.begin + index * map.page_size);
+    std::vector<int>   status(pages.size(), -1);
+    if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) == 0)
+      for (std::size_t index = 0; index < status.size(); ++index)
+        map.nodes[index] = status[index] >= 0 ? integer(status[index]) : -1;
+#endif
+    return map;
+  }
+
+  // The arenas bind their threads to their nodes, hence the pinning applies without per-node arenas only.
+  void                              configure   (const bool pin, const bool per_node_arenas)
+  {
+    observers_  .clear();
+    arenas_     .clear();
+    arena_nodes_.clear();
+
+    const auto nodes = tbb::info::numa_nodes();
+    if (per_node_arenas && nodes.size() > 1)
+      for (const auto node : nodes)
+      {
+        arenas_     .push_back(std::make_unique<tbb::task_arena>(tbb::task_arena::constraints(node)));
+        arena_nodes_.push_back(integer(node));
+        observers_  .push_back(std::make_unique<observer>(*this, false, *arenas_.back()));
+      }
+    else
+      observers_.push_back(std::make_unique<observer>(*this, pin));
+  }
+
+  // The number of per-node arenas, 0 without.
+  std::size_t                       arena_count () const
+  {
+    return arenas_.size();
+  }
+  // The arena of a node, arena_count() if none.
+  std::size_t                       arena       (const integer node) const
+  {
+    return std::size_t(std::find(arena_nodes_.begin(), arena_nodes_.end(), node) - arena_nodes_.begin());
+  }
+  // The bounds of the contiguous ranges of [0, count) per arena (one range without arenas), proportional to their concurrency.
+  std::vector<std::size_t>          bounds      (const std::size_t count) const
+  {
+    if (arenas_.empty())
+      return {0, count};
+
+    std::size_t concurrency = 0;
+    for (auto& arena : arenas_)
+      concurrency += std::size_t(arena->max_concurrency());
+
+    std::vector<std::size_t> bounds(arenas_.size() + 1, 0);
+    std::size_t              accumulated = 0;
+    for (std::size_t index = 0; index < arenas_.size(); ++index)
+    {
+      accumulated      += std::size_t(arenas_[index]->max_concurrency());
+      bounds[index + 1] = count * accumulated / concurrency;
+    }
+    return bounds;
+  }
+  // The bounds of the thread slots per arena (one range of the current concurrency without arenas).
+  std::vector<std::size_t>          slot_bounds () const
+  {
+    std::vector<std::size_t> bounds {0};
+    if (arenas_.empty())
+      bounds.push_back(std::size_t(tbb::this_task_arena::max_concurrency()));
+    for (auto& arena : arenas_)
+      bounds.push_back(bounds.back() + std::size_t(arena->max_concurrency()));
+    return bounds;
+  }
+
+  // Calls function(index) for each index in [0, count), split by bounds(count). Within each arena, the partitioner applies.
+  template <typename function_type, typename partitioner_type = tbb::auto_partitioner>
+  void                              parallel_for(const std::size_t count, const function_type& function, partitioner_type partitioner = partitioner_type()) const
+  {
+    parallel_for(bounds(count), function, partitioner);
+  }
+  // Calls function(index) for each index in [bounds[i], bounds[i + 1]) within the i-th arena (the whole range without arenas).
+  template <typename function_type, typename partitioner_type = tbb::auto_partitioner>
+  void                              parallel_for(const std::vector<std::size_t>& bounds, const function_type& function, partitioner_type partitioner = partitioner_type()) const
+  {
+    if (arenas_.empty())
+    {
+      tbb::parallel_for(bounds.front(), bounds.back(), std::size_t(1), function, partitioner);
+      return;
+    }
+
+    std::vector<tbb::task_group> groups(arenas_.size());
+    for (std::size_t index = 0; index < arenas_.size(); ++index)
+    {
+      const auto begin = bounds[index], end = bounds[index + 1];
+      arenas_[index]->execute([&, index, begin, end] { groups[index].run([&, begin, end] { tbb::parallel_for(begin, end, std::size_t(1), function, partitioner); }); });
+    }
+    for (std::size_t index = 0; index < arenas_.size(); ++index)
+      arenas_[index]->execute([&, index] { groups[index].wait(); });
+  }
+
+  // The number of threads (which joined an observed arena) per node.
+  std::map<integer, std::size_t>    thread_nodes() const
+  {
+    std::map<integer, std::size_t> counts;
+    for (auto& thread : threads_)
+      ++counts[thread.second];
+    return counts;
+  }
+
+protected:
+  class observer : public tbb::task_scheduler_observer
+  {
+  public:
+    observer (numa_domains& domains, const bool pin)
+    : tbb::task_scheduler_observer(), domains_(domains), pin_(pin)
+    {
+      observe(true);
+    }
+    observer (numa_domains& domains, const bool pin, tbb::task_arena& arena)
+    : tbb::task_scheduler_observer(arena), domains_(domains), pin_(pin)
+    {
+      observe(true);
+    }
+   ~observer () override
+    {
+      observe(false);
+    }
+
+    void on_scheduler_entry(const bool is_worker) override
+    {
+#ifdef __linux__
+      // A worker takes its CPU on its first entry and keeps it across arenas and entries. The main thread keeps the process mask.
+      thread_local auto pinned = false;
+      if (pin_ && is_worker && !std::exchange(pinned, true))
+      {
+        const auto slot = domains_.next_cpu_++;
+        cpu_set_t  set;
+        CPU_ZERO(&set);
+        CPU_SET (domains_.cpus_[slot % domains_.cpus_.size()], &set);
+        sched_setaffinity(0, sizeof set, &set);
+      }
+#endif
+      domains_.threads_[std::this_thread::get_id()] = current_node();
+    }
+
+  protected:
+    numa_domains& domains_;
+    bool          pin_    ;
+  };
+
+  numa_domains()
+  {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) == 0)
+      for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &set))
+          cpus_.push_back(cpu);
+#endif
+    if (cpus_.empty())
+      cpus_.push_back(0);
+  }
+
+  std::vector<int>                                             cpus_        {};
+  std::atomic<std::size_t>                                     next_cpu_    {0};
+  std::vector<std::unique_ptr<tbb::task_arena>>                arenas_      {};
+  std::vector<integer>                                         arena_nodes_ {};
+  std::vector<std::unique_ptr<observer>>                       observers_   {};
+  tbb::concurrent_unordered_map<std::thread::id, integer>      threads_     {};
+};
+}
+
+#endif
@@ -13,7 +13,7 @@ const std::string xdmf_header = R"(<?xml version ="1.0" ?>
 const std::string xdmf_body   = R"(
     <Grid Name="$GRID_NAME">
 
-      <Topology TopologyType="Polyline" NodesPerElement="2" NumberOfElements="$POLYLINE_COUNT">
+      <Topology TopologyType="$TOPOLOGY_TYPE"$NODES_PER_ELEMENT NumberOfElements="$ELEMENT_COUNT">
         <DataItem Dimensions="$INDEX_ARRAY_SIZE" NumberType="UInt" Precision="$INDEX_PRECISION" Format="HDF">
           $FILEPATH:/$INDICES_DATASET_NAME
         </DataItem>
@@ -1,31 +1,125 @@
 #include <dpa/pipeline.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <utility>
+#include <variant>
+
+#include <boost/mpi/collectives/reduce.hpp>
+#include <boost/mpi/communicator.hpp>
 #include <boost/mpi/environment.hpp>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
 
+#include <dpa/benchmark/advection_counters.hpp>
 #include <dpa/benchmark/benchmark.hpp>
+#include <dpa/benchmark/scaling_metrics.hpp>
+#include <dpa/stages/analytic_field_generator.hpp>
 #include <dpa/stages/argument_parser.hpp>
 #include <dpa/stages/regular_grid_loader.hpp>
 #include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/stages/ftle_estimator.hpp>
+#include <dpa/stages/importance_seed_generator.hpp>
 #include <dpa/stages/integral_curve_saver.hpp>
+#include <dpa/stages/integral_curve_spiller.hpp>
 #include <dpa/stages/particle_advector.hpp>
+#include <dpa/stages/particle_checkpointer.hpp>
+#include <dpa/stages/round_tuner.hpp>
+#include <dpa/stages/seed_file_loader.hpp>
 #include <dpa/stages/uniform_seed_generator.hpp>
+#include <dpa/utility/logger.hpp>
+#include <dpa/utility/numa_domains.hpp>
 
 namespace dpa
 {
 std::int32_t pipeline::run(std::int32_t argc, char** argv)
 {
-  boost::mpi::environment environment(argc, argv, boost::mpi::threading::level::serialized);
-  std::cout << "Started pipeline on " << environment.processor_name() << "\n";
+  auto arguments          = argument_parser::parse(argv[1]);
+
+  // The streaming handoff sends from the worker threads and receives on a progress thread, hence requires MPI_THREAD_MULTIPLE.
+  auto handoff_batch_size = arguments.particle_advector_handoff_batch_size.value_or(0);
+  boost::mpi::environment environment(argc, argv, handoff_batch_size > 0 ? boost::mpi::threading::level::multiple : boost::mpi::threading::level::serialized);
+
+  auto& log               = logger::instance();
+  log.configure(logger::parse_level(arguments.log_level.value_or("info")), std::size_t(arguments.log_rate_limit.value_or(100)), arguments.log_aggregate.value_or(false));
+  log.info("Started pipeline on ", environment.processor_name());
+  if (handoff_batch_size > 0 && environment.thread_level() < boost::mpi::threading::level::multiple)
+  {
+    log.warning("MPI_THREAD_MULTIPLE is unavailable. Falling back to the handoff between rounds.");
+    handoff_batch_size = 0;
+  }
+
+  auto thread_limit       = tbb::global_control(tbb::global_control::max_allowed_parallelism, arguments.thread_count ? std::size_t(*arguments.thread_count) : tbb::this_task_arena::max_concurrency());
+  numa_domains::instance().configure(arguments.thread_pinning.value_or(false), arguments.thread_numa_arenas.value_or(false));
+  auto warm               = arguments.benchmark_mode.value_or("cold") == "warm";
+  auto iterations         = std::size_t(arguments.benchmark_iterations       .value_or(10));
+  auto warmup_iterations  = std::size_t(arguments.benchmark_warmup_iterations.value_or(0 ));
+  auto iteration          = std::size_t(0); // Including the warmup iterations.
+  auto particle_steps     = std::vector<std::vector<std::size_t>>(); // Per measured iteration, per round.
+  auto memory_budget      = std::size_t(arguments.particle_advector_memory_budget.value_or(0) * 1024 * 1024); // Bytes per rank, half for the curves of a round and half for the retained curves.
+  auto restart            = arguments.checkpoint_restart.value_or(false); // Applies to the first iteration only.
+#ifdef DPA_COUNTER_SUPPORT
+  std::ostringstream counter_stream;
+#endif
+  std::ostringstream tuner_stream;
+
+  const auto load         = [&] (session_recorder<float, std::milli>& recorder, domain_partitioner& partitioner, std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields)
+  {
+    auto loader          = arguments.input_analytic_field
+      ? std::variant<regular_grid_loader, analytic_field_generator>(std::in_place_type<analytic_field_generator>,
+        &partitioner                              ,
+        *arguments.input_analytic_field           ,
+        *arguments.input_analytic_field_dimensions,
+        arguments.input_analytic_field_spacing    )
+      : std::variant<regular_grid_loader, analytic_field_generator>(std::in_place_type<regular_grid_loader>     ,
+        &partitioner                              , 
+        arguments.input_dataset_filepath          , 
+        arguments.input_dataset_name              , 
+        arguments.input_dataset_spacing_name      );
+
+    log.debug("1.domain_partitioning");
+    recorder.record("1.domain_partitioning", [&] ()
+    {
+      partitioner.set_domain_size(std::visit([ ] (auto& cast_loader) { return cast_loader.load_dimensions(); }, loader), ivector3::Ones());
+    });
+    log.debug("2.data_loading");
+    recorder.record("2.data_loading"       , [&] ()
+    {
+      const auto load_neighbors = 
+        arguments.particle_advector_load_balancer == "diffuse_constant"                       || 
+        arguments.particle_advector_load_balancer == "diffuse_lesser_average"                 || 
+        arguments.particle_advector_load_balancer == "diffuse_greater_limited_lesser_average" ;
+      vector_fields = std::visit([&] (auto& cast_loader) { return cast_loader.load_vector_fields(load_neighbors); }, loader);
+    });
+
+    if (arguments.thread_pinning || arguments.thread_numa_arenas)
+    {
+      const auto& field      = vector_fields[relative_direction::center];
+      const auto  page_map   = numa_domains::map_pages(field.data.data(), field.data.num_elements() * sizeof(vector3));
+      auto        page_nodes = std::map<integer, std::size_t>();
+      for (const auto node : page_map.nodes)
+        ++page_nodes[node];
 
-  auto arguments         = argument_parser::parse(argv[1]);
-  auto benchmark_session = run_mpi<float, std::milli>([&] (session_recorder<float, std::milli>& recorder)
+      std::ostringstream stream;
+      stream << "Field pages per NUMA node:";
+      for (const auto& node : page_nodes)
+        stream << " " << node.first << ": " << node.second;
+      stream << ", threads per NUMA node:";
+      for (const auto& node : numa_domains::instance().thread_nodes())
+        stream << " " << node.first << ": " << node.second;
+      log.info(stream.str());
+    }
+  };
+  const auto advect       = [&] (session_recorder<float, std::milli>& recorder, domain_partitioner& partitioner, std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields)
   {
-    auto partitioner     = domain_partitioner ();
-    auto loader          = regular_grid_loader(
-      &partitioner                        , 
-      arguments.input_dataset_filepath    , 
-      arguments.input_dataset_name        , 
-      arguments.input_dataset_spacing_name);
+    const auto measured  = iteration++ >= warmup_iterations;
+
     auto advector        = particle_advector(
       &partitioner                                   , 
       arguments.particle_advector_particles_per_round,
@@ -33,34 +127,64 @@ std::int32_t pipeline::run(std::int32_t argc, char** argv)
       arguments.particle_advector_integrator         ,
       arguments.particle_advector_step_size          ,
       arguments.particle_advector_gather_particles   ,
-      arguments.particle_advector_record             );
+      arguments.particle_advector_record             ,
+      curve_decimator<vector3>(
+        arguments.particle_advector_record_stride ? std::size_t(*arguments.particle_advector_record_stride) :
+        arguments.particle_advector_record_spacing || arguments.particle_advector_record_tolerance ? std::numeric_limits<std::size_t>::max() : 1,
+        arguments.particle_advector_record_spacing           ,
+        arguments.particle_advector_record_tolerance         ),
+      termination_criteria {
+        arguments.termination_minimum_speed                  ,
+        arguments.termination_maximum_arc_length             ,
+        arguments.termination_maximum_time                   ,
+        arguments.termination_region                         ,
+        arguments.termination_stagnation_window              ,
+        arguments.termination_stagnation_distance.value_or(0)},
+      handoff_batch_size                                      ,
+      arguments.particle_advector_scheduling.value_or("lifo") ,
+      memory_budget / 2                                       );
 
-    auto vector_fields   = std::unordered_map<relative_direction, regular_vector_field_3d>();
     auto particles       = std::vector<particle<vector3, integer>>();
 
-    std::cout << "1.domain_partitioning\n";
-    recorder.record("1.domain_partitioning", [&] ()
-    {
-      partitioner.set_domain_size(loader.load_dimensions(), ivector3::Ones());
-    });
-    std::cout << "2.data_loading\n";
-    recorder.record("2.data_loading"       , [&] ()
+    // The warm mode does not save, hence does not spill either.
+    auto spiller         = std::optional<integral_curve_spiller>();
+    if (arguments.particle_advector_record && memory_budget > 0 && !warm)
+      spiller.emplace(&partitioner, arguments.particle_advector_spill_directory.value_or(std::filesystem::path(arguments.output_dataset_filepath).parent_path().string()), arguments.output_dataset_filepath, memory_budget / 2);
+
+    auto tuner           = std::optional<round_tuner>();
+    if (arguments.particle_advector_tuner_round_time)
+      tuner.emplace(&partitioner, arguments.particle_advector_particles_per_round, *arguments.particle_advector_tuner_round_time, arguments.particle_advector_memory_budget);
+
+    auto checkpointer    = std::optional<particle_checkpointer>();
+    auto restored        = std::optional<particle_checkpointer::state>();
+    if (arguments.checkpoint_rounds || arguments.checkpoint_seconds)
     {
-      vector_fields = loader.load_vector_fields(
-        arguments.particle_advector_load_balancer == "diffuse_constant"                       || 
-        arguments.particle_advector_load_balancer == "diffuse_lesser_average"                 || 
-        arguments.particle_advector_load_balancer == "diffuse_greater_limited_lesser_average" );
-    });
-    std::cout << "3.seed_generation\n";
+      checkpointer.emplace(&partitioner, arguments.output_dataset_filepath, arguments.checkpoint_rounds.value_or(0), arguments.checkpoint_seconds.value_or(scalar(0)));
+      if (std::exchange(restart, false))
+        restored = checkpointer->load();
+    }
+
+    log.debug("3.seed_generation");
     recorder.record("3.seed_generation"    , [&] ()
     {
+      if (restored) // The particles are restored from the checkpoint instead.
+        return;
+
       auto offset        = vector_fields[relative_direction::center].spacing.array() * partitioner.partitions().at(relative_direction::center).offset.cast<scalar>().array();
       auto size          = vector_fields[relative_direction::center].spacing.array() * partitioner.block_size()                                      .cast<scalar>().array();
       auto iterations    = arguments.seed_generation_iterations;
       auto process_index = partitioner.cartesian_communicator()->rank();
       auto boundaries    = arguments.seed_generation_boundaries ? arguments.seed_generation_boundaries : std::nullopt;
 
-      if      (arguments.seed_generation_stride)
+      if      (arguments.seed_generation_filepath)
+        particles = seed_file_loader(
+          &partitioner                                            ,
+          *arguments.seed_generation_filepath                     ,
+          arguments.seed_generation_dataset_name                  ).load(
+          vector_fields[relative_direction::center].spacing       ,
+          iterations                                              ,
+          boundaries                                              );
+      else if (arguments.seed_generation_stride)
         particles = uniform_seed_generator::generate(
           offset       ,
           size         , 
@@ -68,6 +192,17 @@ std::int32_t pipeline::run(std::int32_t argc, char** argv)
           iterations   , 
           process_index,
           boundaries   );
+      else if (arguments.seed_generation_count && arguments.seed_generation_importance)
+        particles = importance_seed_generator::generate(
+          vector_fields[relative_direction::center],
+          offset       ,
+          size         , 
+          *arguments.seed_generation_count,
+          iterations   , 
+          process_index,
+          importance_seed_generator::density(*arguments.seed_generation_importance),
+          boundaries   ,
+          std::uint32_t(arguments.seed_generation_seed.value_or(0)));
       else if (arguments.seed_generation_count)
         particles = uniform_seed_generator::generate_random(
           offset       ,
@@ -75,7 +210,8 @@ std::int32_t pipeline::run(std::int32_t argc, char** argv)
           *arguments.seed_generation_count,
           iterations   , 
           process_index,
-          boundaries   );
+          boundaries   ,
+          std::uint32_t(arguments.seed_generation_seed.value_or(0)));
       else if (arguments.seed_generation_range)
         particles = uniform_seed_generator::generate_random(
           offset       ,
@@ -83,72 +219,251 @@ std::int32_t pipeline::run(std::int32_t argc, char** argv)
           *arguments.seed_generation_range,
           iterations   , 
           process_index,
-          boundaries   );
+          boundaries   ,
+          std::uint32_t(arguments.seed_generation_seed.value_or(0)));
     });
 
+    // Interned once, the round stages accumulate one sample per round under a single record each.
+    const auto rounds_stage                   = recorder.intern("4.rounds");
+    const auto load_balance_distribute_stage  = recorder.intern("4.1.load_balance_distribute" , rounds_stage);
+    const auto compute_round_info_stage       = recorder.intern("4.2.compute_round_info"      , rounds_stage);
+    const auto allocate_integral_curves_stage = recorder.intern("4.3.allocate_integral_curves", rounds_stage);
+    const auto advect_stage                   = recorder.intern("4.4.advect"                  , rounds_stage);
+    const auto load_balance_collect_stage     = recorder.intern("4.5.load_balance_collect"    , rounds_stage);
+    const auto out_of_bounds_distribute_stage = recorder.intern("4.6.out_of_bounds_distribute", rounds_stage);
+    const auto check_completion_stage         = recorder.intern("4.7.check_completion"        , rounds_stage);
+    const auto checkpoint_stage               = checkpointer ? recorder.intern("4.8.checkpoint", rounds_stage) : 0;
+    const auto spilling_stage                 = spiller      ? recorder.intern("4.9.spilling"  , rounds_stage) : 0;
+    const auto tuning_stage                   = tuner        ? recorder.intern("4.10.tuning"   , rounds_stage) : 0;
+
     particle_advector::output output   = {};
     integer                   rounds   = 0;
     bool                      complete = false;
+    auto                      steps    = std::vector<std::size_t>();
+    auto                      counts   = std::vector<double>(); // Particles advected per round.
+    if (restored)
+    {
+      particles        = std::move(restored->active_particles  );
+      output.particles = std::move(restored->inactive_particles);
+      rounds           = restored->round;
+      log.info("Restarted from the checkpoint of round ", rounds, " with ", particles.size(), " active particles");
+    }
     while (!complete)
     {
+      const auto round_timer = recorder.time(rounds_stage);
+
       particle_advector::round_info round_info;
-      std::cout << "4.1." + std::to_string(rounds) + ".load_balance_distribute\n";
-      recorder.record("4.1." + std::to_string(rounds) + ".load_balance_distribute" , [&] ()
+      log.debug("4.1.", rounds, ".load_balance_distribute");
+      recorder.record(load_balance_distribute_stage , [&] ()
       {
                      advector.load_balance_distribute (               particles                                                      );
       });
-      std::cout << "4.2." + std::to_string(rounds) + ".compute_round_info\n";
-      recorder.record("4.2." + std::to_string(rounds) + ".compute_round_info"      , [&] ()
+      log.debug("4.2.", rounds, ".compute_round_info");
+      recorder.record(compute_round_info_stage      , [&] ()
       {
         round_info = advector.compute_round_info      (               particles                                                      );
       });
-      std::cout << "4.3." + std::to_string(rounds) + ".allocate_integral_curves\n";
-      recorder.record("4.3." + std::to_string(rounds) + ".allocate_integral_curves", [&] ()
+      log.debug("4.3.", rounds, ".allocate_integral_curves");
+      recorder.record(allocate_integral_curves_stage, [&] ()
       {
                      advector.allocate_integral_curves(                                            output.integral_curves, round_info);
       });
-      std::cout << "4.4." + std::to_string(rounds) + ".advect\n";
-      recorder.record("4.4." + std::to_string(rounds) + ".advect"                  , [&] ()
+      log.debug("4.4.", rounds, ".advect");
+      recorder.record(advect_stage                  , [&] ()
       {
                      advector.advect                  (vector_fields, particles, output.particles, output.integral_curves, round_info);
       });
-      std::cout << "4.5." + std::to_string(rounds) + ".load_balance_collect\n";
-      recorder.record("4.5." + std::to_string(rounds) + ".load_balance_collect"    , [&] ()
+      steps .push_back(round_info.particle_steps);
+      counts.push_back(round_info.particle_count);
+      const auto round_memory = arguments.particle_advector_record ? integral_curve_spiller::memory(output.integral_curves.back()) : 0; // Before spilling.
+      log.debug("4.5.", rounds, ".load_balance_collect");
+      recorder.record(load_balance_collect_stage    , [&] ()
       {
                      advector.load_balance_collect    (vector_fields,            output.particles,                         round_info);
       });
-      std::cout << "4.6." + std::to_string(rounds) + ".out_of_bounds_distribute\n";
-      recorder.record("4.6." + std::to_string(rounds) + ".out_of_bounds_distribute", [&] ()
+      log.debug("4.6.", rounds, ".out_of_bounds_distribute");
+      recorder.record(out_of_bounds_distribute_stage, [&] ()
       {
                      advector.out_of_bounds_distribute(               particles,                                           round_info);
       });
-      std::cout << "4.7." + std::to_string(rounds) + ".check_completion\n";
-      recorder.record("4.7." + std::to_string(rounds) + ".check_completion"        , [&] ()
+      log.debug("4.7.", rounds, ".check_completion");
+      recorder.record(check_completion_stage        , [&] ()
       {
         complete =   advector.check_completion        (               particles                                                      );
       });  
       rounds++;
+
+      if (checkpointer && !complete && checkpointer->due(rounds))
+      {
+        log.debug("4.8.", rounds, ".checkpoint");
+        recorder.record(checkpoint_stage            , [&] ()
+        {
+          checkpointer->save(rounds, particles, output.particles);
+        });
+      }
+
+      if (spiller)
+      {
+        log.debug("4.9.", rounds, ".spilling");
+        recorder.record(spilling_stage              , [&] ()
+        {
+          spiller->spill(output.integral_curves);
+        });
+      }
+
+      if (tuner && !complete)
+      {
+        log.debug("4.10.", rounds, ".tuning");
+        recorder.record(tuning_stage                , [&] ()
+        {
+          round_tuner::measurement measurement;
+          measurement.particle_count     = round_info.particle_count;
+          measurement.advection_time     = recorder.last_sample(advect_stage);
+          for (const auto stage : {load_balance_distribute_stage, compute_round_info_stage, allocate_integral_curves_stage, load_balance_collect_stage, out_of_bounds_distribute_stage, check_completion_stage})
+            measurement.communication_time += recorder.last_sample(stage);
+          measurement.round_memory       = round_memory;
+          measurement.memory             = integral_curve_spiller::memory(output.integral_curves) + (particles.size() + output.particles.size()) * sizeof(particle<vector3, integer>);
+
+          advector.particles_per_round_  = tuner->update(measurement);
+          const auto& decision           = tuner->decisions().back();
+          log.debug("Tuned the particles per round to ", decision.quota, " (time quota ", decision.time_quota, ", memory quota ", decision.memory_quota, ", limited by ", decision.limit, ")");
+        });
+      }
     }
-    std::cout << "4.8.gather_particles\n";
-    recorder.record("4.8.gather_particles"     , [&] ()
+    // Aggregated after the rounds to keep the reductions out of the timed regions.
+    log.reduce(logger::level::info, "4.rounds"               , double(rounds));
+    log.reduce(logger::level::info, "4.rounds.particle_count", counts);
+    log.reduce(logger::level::info, "4.rounds.particle_steps", std::vector<double>(steps.begin(), steps.end()));
+    if (tuner && partitioner.cartesian_communicator()->rank() == 0)
+      log.info("Tuned the particles per round to ", tuner->quota(), " over ", tuner->decisions().size(), " decisions");
+
+    termination_criteria::counts termination_counts {};
+    boost::mpi::reduce(*partitioner.cartesian_communicator(), advector.termination_counts_.data(), int(termination_counts.size()), termination_counts.data(), std::plus<std::size_t>(), 0);
+    if (partitioner.cartesian_communicator()->rank() == 0)
     {
-      advector.gather_particles     (output.particles);
-    });
-    std::cout << "4.9.prune_integral_curves\n";
-    recorder.record("4.9.prune_integral_curves", [&] ()
+      std::ostringstream stream;
+      for (std::size_t index = 0; index < termination_counts.size(); ++index)
+        stream << (index ? ", " : "") << termination_criteria::names[index] << " " << termination_counts[index];
+      log.info("Terminated particles per reason: ", stream.str());
+    }
+    log.debug("4.8.gather_particles");
+    recorder.record("4.8.gather_particles", [&] ()
     {
-      advector.prune_integral_curves(output.integral_curves);
+      advector.gather_particles(output.particles);
     });
 
-    std::cout << "5.data_saving\n";
-    recorder.record("5.data_saving"            , [&] ()
+    if (arguments.output_ftle.value_or(false) && arguments.seed_generation_stride && arguments.particle_advector_gather_particles)
     {
-      if (arguments.particle_advector_record)
-        integral_curve_saver(&partitioner, arguments.output_dataset_filepath).save_integral_curves(output.integral_curves, (std::size_t(arguments.particle_advector_particles_per_round) * arguments.seed_generation_iterations) > std::numeric_limits<std::uint32_t>::max());
-    });
-  }, 10);
+      const auto estimator = ftle_estimator(
+        &partitioner                                     ,
+        vector_fields[relative_direction::center].spacing,
+        *arguments.seed_generation_stride                ,
+        arguments.seed_generation_boundaries             );
+
+      auto ftle = std::optional<regular_scalar_field_3d>();
+      log.debug("4.9.ftle_estimation");
+      recorder.record("4.9.ftle_estimation", [&] ()
+      {
+        ftle.emplace(estimator.estimate(output.particles));
+      });
+
+      auto minimum = std::numeric_limits<double>::max(), maximum = std::numeric_limits<double>::lowest(), sum = 0.0, count = 0.0;
+      std::for_each(ftle->data.data(), ftle->data.data() + ftle->data.num_elements(), [&] (const scalar value)
+      {
+        if (std::isnan(value))
+          return;
+        minimum = std::min(minimum, double(value));
+        maximum = std::max(maximum, double(value));
+        sum    += value;
+        count  += 1.0;
+      });
+      if (count > 0.0)
+        log.debug("FTLE minimum ", minimum, " mean ", sum / count, " maximum ", maximum, " over ", count, " seeds");
+      log.reduce(logger::level::info, "4.9.ftle_estimation.seeds", count);
+
+      if (!warm)
+        recorder.record("5.ftle_saving", [&] ()
+        {
+          estimator.save(*ftle, std::filesystem::path(arguments.output_dataset_filepath).replace_extension(".ftle.h5").string());
+        });
+    }
+
+    // The warm mode measures the advection engine alone, hence does not save.
+    if (!warm)
+    {
+      log.debug("5.data_saving");
+      recorder.record("5.data_saving"       , [&] ()
+      {
+        if (arguments.particle_advector_record)
+          integral_curve_saver(
+            &partitioner                                            ,
+            arguments.output_dataset_filepath                       ,
+            arguments.output_topology        .value_or("segments")  ,
+            arguments.output_vertex_encoding .value_or("raw")       ,
+            vector_fields[relative_direction::center].offset        ,
+            arguments.output_vertex_precision.value_or(scalar(1e-4))).save_integral_curves(output.integral_curves, spiller ? &*spiller : nullptr);
+      });
+    }
+
+    // The run is complete, hence its checkpoints are obsolete.
+    if (checkpointer)
+      checkpointer->remove();
+
+    if (!measured)
+      return;
+
+    particle_steps.push_back(std::move(steps));
+#ifdef DPA_COUNTER_SUPPORT
+    for (std::size_t round = 0; round < advector.round_counters_.size(); ++round)
+      counter_stream << partitioner.cartesian_communicator()->rank() << "," << iteration - warmup_iterations - 1 << "," << round << "," << advector.round_counters_[round].to_string() << "\n";
+#endif
+    // The decisions are the same on all ranks.
+    if (tuner)
+      for (const auto& decision : tuner->decisions())
+        tuner_stream << iteration - warmup_iterations - 1 << "," << decision.to_string() << "\n";
+  };
+
+  // The cold mode repeats the whole pipeline. The warm mode loads once, as in a persistent (e.g. in situ) setting, and repeats the seed generation and advection.
+  auto partitioner        = domain_partitioner();
+  auto vector_fields      = std::unordered_map<relative_direction, regular_vector_field_3d>();
+  if (warm)
+  {
+    session<float>                      load_session;
+    session_recorder<float, std::milli> load_recorder(0, 1, load_session);
+    load(load_recorder, partitioner, vector_fields);
+  }
+
+  auto benchmark_session  = run_mpi<float, std::milli>([&] (session_recorder<float, std::milli>& recorder)
+  {
+    if (warm)
+      advect(recorder, partitioner, vector_fields);
+    else
+    {
+      auto cold_partitioner   = domain_partitioner();
+      auto cold_vector_fields = std::unordered_map<relative_direction, regular_vector_field_3d>();
+      load  (recorder, cold_partitioner, cold_vector_fields);
+      advect(recorder, cold_partitioner, cold_vector_fields);
+    }
+  }, iterations, warmup_iterations);
   benchmark_session.gather();
-  benchmark_session.to_csv(arguments.output_dataset_filepath + ".benchmark.csv");
+  benchmark_session.to_csv        (arguments.output_dataset_filepath + ".benchmark.csv"        );
+  benchmark_session.samples_to_csv(arguments.output_dataset_filepath + ".benchmark.samples.csv");
+  benchmark_session.trace_to_json (arguments.output_dataset_filepath + ".trace.json"           );
+  write_scaling_metrics<float, std::milli>(
+    arguments.output_dataset_filepath + ".metrics.json"       ,
+    benchmark_session                                         ,
+    benchmark_session.record_indices.at("4.rounds")           ,
+    benchmark_session.record_indices.at("4.rounds/4.4.advect"),
+    particle_steps                                            ,
+    tbb::this_task_arena::max_concurrency()                   );
+
+#ifdef DPA_COUNTER_SUPPORT
+  const auto counters = mpi_gather_string(counter_stream.str());
+  if (boost::mpi::communicator().rank() == 0)
+    std::ofstream(arguments.output_dataset_filepath + ".counters.csv") << "rank,iteration,round," << advection_counters::csv_header() << "\n" << counters;
+#endif
+  if (arguments.particle_advector_tuner_round_time && boost::mpi::communicator().rank() == 0)
+    std::ofstream(arguments.output_dataset_filepath + ".tuner.csv") << "iteration," << round_tuner::decision::csv_header() << "\n" << tuner_stream.str();
   return 0;
 }
 }
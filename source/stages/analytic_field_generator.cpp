@@ -0,0 +1,74 @@
+#include <dpa/stages/analytic_field_generator.hpp>
+
+#include <stdexcept>
+
+#include <tbb/tbb.h>
+
+#include <dpa/math/analytic_flows.hpp>
+
+namespace dpa
+{
+analytic_field_generator::analytic_field_generator (domain_partitioner* partitioner, const std::string& type, const ivector3& dimensions, const std::optional<vector3>& spacing)
+: partitioner_(partitioner), dimensions_(dimensions)
+{
+  if      (type == "abc"           ) type_ = type::abc;
+  else if (type == "double_gyre"   ) type_ = type::double_gyre;
+  else if (type == "rankine_vortex") type_ = type::rankine_vortex;
+  else if (type == "uniform"       ) type_ = type::uniform;
+  else                               throw std::invalid_argument("input_analytic_field must be either \"abc\", \"double_gyre\", \"rankine_vortex\" or \"uniform\", not \"" + type + "\".");
+
+  spacing_ = spacing ? *spacing : vector3(extent(type_).array() / (dimensions_.cast<scalar>().array() - scalar(1)));
+}
+
+ivector3                                                        analytic_field_generator::load_dimensions   ()
+{
+  return dimensions_;
+}
+std::unordered_map<relative_direction, regular_vector_field_3d> analytic_field_generator::load_vector_fields(const bool load_neighbors)
+{
+  std::unordered_map<relative_direction, regular_vector_field_3d> vector_fields;
+
+  auto partitions = partitioner_->partitions();
+
+  vector_fields.emplace(relative_direction::center, load_vector_field(partitions.at(relative_direction::center).ghosted_offset, partitions.at(relative_direction::center).ghosted_block_size));
+  if (load_neighbors)
+    for (auto direction : {relative_direction::negative_x, relative_direction::positive_x, relative_direction::negative_y, relative_direction::positive_y, relative_direction::negative_z, relative_direction::positive_z})
+      if (partitions.find(direction) != partitions.end())
+        vector_fields.emplace(direction, load_vector_field(partitions.at(direction).ghosted_offset, partitions.at(direction).ghosted_block_size));
+
+  return vector_fields;
+}
+
+vector3                                                         analytic_field_generator::extent            (const type flow)
+{
+  if      (flow == type::double_gyre   ) return vector3(2, 1, 1);
+  else if (flow == type::rankine_vortex) return vector3(2, 2, 2);
+  else if (flow == type::uniform       ) return vector3(1, 1, 1);
+  return vector3::Constant(2 * analytic_flows::pi);
+}
+
+regular_vector_field_3d                                         analytic_field_generator::load_vector_field (const ivector3& offset, const ivector3& size) const
+{
+  regular_vector_field_3d vector_field {regular_vector_field_3d::array_type(boost::extents[size[0]][size[1]][size[2]])};
+  vector_field.spacing = spacing_;
+  vector_field.offset  = offset.cast<scalar>().array() * vector_field.spacing.array();
+  vector_field.size    = size  .cast<scalar>().array() * vector_field.spacing.array();
+
+  tbb::parallel_for(tbb::blocked_range2d<integer>(0, size[0], 0, size[1]), [&] (const tbb::blocked_range2d<integer>& range)
+  {
+    for (auto x = range.rows().begin(); x != range.rows().end(); ++x)
+      for (auto y = range.cols().begin(); y != range.cols().end(); ++y)
+        for (auto z = 0; z < size[2]; ++z)
+          vector_field.data[x][y][z] = evaluate(vector_field.offset + vector3(x, y, z).cwiseProduct(vector_field.spacing));
+  });
+
+  return vector_field;
+}
+vector3                                                         analytic_field_generator::evaluate          (const vector3& position) const
+{
+  if      (type_ == type::double_gyre   ) return analytic_flows::double_gyre   (position);
+  else if (type_ == type::rankine_vortex) return analytic_flows::rankine_vortex(position, extent(type_) / 2);
+  else if (type_ == type::uniform       ) return analytic_flows::uniform       (position);
+  return analytic_flows::abc(position);
+}
+}
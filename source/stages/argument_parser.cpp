@@ -1,6 +1,7 @@
 #include <dpa/stages/argument_parser.hpp>
 
 #include <fstream>
+#include <stdexcept>
 
 #include <nlohmann/json.hpp>
 
@@ -13,9 +14,23 @@ arguments argument_parser::parse(const std::string& filepath)
   file >> json;
 
   arguments arguments;
-  arguments.input_dataset_filepath                = json["input_dataset_filepath"               ]   .get<std::string>();
-  arguments.input_dataset_name                    = json["input_dataset_name"                   ]   .get<std::string>();
-  arguments.input_dataset_spacing_name            = json["input_dataset_spacing_name"           ]   .get<std::string>();
+  if (json.contains("input_analytic_field"))
+  {
+    auto dimensions = json["input_analytic_field_dimensions"];
+    arguments.input_analytic_field                = json["input_analytic_field"                 ]   .get<std::string>();
+    arguments.input_analytic_field_dimensions     = ivector3(dimensions[0].get<integer>(), dimensions[1].get<integer>(), dimensions[2].get<integer>());
+    if (json.contains("input_analytic_field_spacing"))
+    {
+      auto spacing  = json["input_analytic_field_spacing"];
+      arguments.input_analytic_field_spacing      = vector3(spacing[0].get<scalar>(), spacing[1].get<scalar>(), spacing[2].get<scalar>());
+    }
+  }
+  else
+  {
+    arguments.input_dataset_filepath              = json["input_dataset_filepath"               ]   .get<std::string>();
+    arguments.input_dataset_name                  = json["input_dataset_name"                   ]   .get<std::string>();
+    arguments.input_dataset_spacing_name          = json["input_dataset_spacing_name"           ]   .get<std::string>();
+  }
   arguments.seed_generation_iterations            = json["seed_generation_iterations"           ]   .get<integer>    ();
   arguments.particle_advector_particles_per_round = json["particle_advector_particles_per_round"]   .get<integer>    ();
   arguments.particle_advector_load_balancer       = json["particle_advector_load_balancer"      ]   .get<std::string>();
@@ -40,6 +55,14 @@ arguments argument_parser::parse(const std::string& filepath)
     auto range  = json["seed_generation_range" ];
     arguments.seed_generation_range  = ivector2(range[0].get<integer>(), range[1].get<integer>());
   }
+  if (json.contains("seed_generation_importance"))
+    arguments.seed_generation_importance   = json["seed_generation_importance"  ].get<std::string>();
+  if (json.contains("seed_generation_seed"))
+    arguments.seed_generation_seed         = json["seed_generation_seed"        ].get<integer>();
+  if (json.contains("seed_generation_filepath"))
+    arguments.seed_generation_filepath     = json["seed_generation_filepath"    ].get<std::string>();
+  if (json.contains("seed_generation_dataset_name"))
+    arguments.seed_generation_dataset_name = json["seed_generation_dataset_name"].get<std::string>();
   if (json.contains("seed_generation_boundaries"))
   {
     auto boundaries = json["seed_generation_boundaries"];
@@ -49,6 +72,81 @@ arguments argument_parser::parse(const std::string& filepath)
       vector3(minimum[0].get<scalar>(), minimum[1].get<scalar>(), minimum[2].get<scalar>()),
       vector3(maximum[0].get<scalar>(), maximum[1].get<scalar>(), maximum[2].get<scalar>()));
   } 
+  if (json.contains("particle_advector_record_stride"))
+  {
+    arguments.particle_advector_record_stride    = json["particle_advector_record_stride"   ].get<integer>();
+    if (*arguments.particle_advector_record_stride < 1)
+      throw std::invalid_argument("particle_advector_record_stride must be positive.");
+  }
+  if (json.contains("particle_advector_record_spacing"))
+    arguments.particle_advector_record_spacing   = json["particle_advector_record_spacing"  ].get<scalar> ();
+  if (json.contains("particle_advector_record_tolerance"))
+    arguments.particle_advector_record_tolerance = json["particle_advector_record_tolerance"].get<scalar> ();
+  if (json.contains("particle_advector_handoff_batch_size"))
+    arguments.particle_advector_handoff_batch_size = json["particle_advector_handoff_batch_size"].get<integer>();
+  if (json.contains("particle_advector_scheduling"))
+    arguments.particle_advector_scheduling       = json["particle_advector_scheduling"      ].get<std::string>();
+  if (json.contains("particle_advector_tuner_round_time"))
+    arguments.particle_advector_tuner_round_time = json["particle_advector_tuner_round_time"].get<scalar> ();
+  if (json.contains("particle_advector_memory_budget"))
+    arguments.particle_advector_memory_budget    = json["particle_advector_memory_budget"   ].get<scalar> ();
+  if (json.contains("particle_advector_spill_directory"))
+    arguments.particle_advector_spill_directory  = json["particle_advector_spill_directory" ].get<std::string>();
+  if (json.contains("termination_minimum_speed"))
+    arguments.termination_minimum_speed          = json["termination_minimum_speed"         ].get<scalar> ();
+  if (json.contains("termination_maximum_arc_length"))
+    arguments.termination_maximum_arc_length     = json["termination_maximum_arc_length"    ].get<scalar> ();
+  if (json.contains("termination_maximum_time"))
+    arguments.termination_maximum_time           = json["termination_maximum_time"          ].get<scalar> ();
+  if (json.contains("termination_region"))
+  {
+    auto region  = json["termination_region"];
+    auto minimum = region["minimum"];
+    auto maximum = region["maximum"];
+    arguments.termination_region = aabb3(
+      vector3(minimum[0].get<scalar>(), minimum[1].get<scalar>(), minimum[2].get<scalar>()),
+      vector3(maximum[0].get<scalar>(), maximum[1].get<scalar>(), maximum[2].get<scalar>()));
+  }
+  if (json.contains("termination_stagnation_window"))
+    arguments.termination_stagnation_window      = json["termination_stagnation_window"     ].get<integer>();
+  if (json.contains("termination_stagnation_distance"))
+    arguments.termination_stagnation_distance    = json["termination_stagnation_distance"   ].get<scalar> ();
+  if (json.contains("output_topology"))
+    arguments.output_topology                    = json["output_topology"                   ].get<std::string>();
+  if (json.contains("output_vertex_encoding"))
+    arguments.output_vertex_encoding             = json["output_vertex_encoding"            ].get<std::string>();
+  if (json.contains("output_vertex_precision"))
+  {
+    arguments.output_vertex_precision            = json["output_vertex_precision"           ].get<scalar> ();
+    if (!(*arguments.output_vertex_precision > scalar(0)))
+      throw std::invalid_argument("output_vertex_precision must be positive.");
+  }
+  if (json.contains("output_ftle"))
+    arguments.output_ftle                        = json["output_ftle"                       ].get<bool>   ();
+  if (json.contains("thread_count"))
+    arguments.thread_count                       = json["thread_count"                      ].get<integer>();
+  if (json.contains("thread_pinning"))
+    arguments.thread_pinning                     = json["thread_pinning"                    ].get<bool>   ();
+  if (json.contains("thread_numa_arenas"))
+    arguments.thread_numa_arenas                 = json["thread_numa_arenas"                ].get<bool>   ();
+  if (json.contains("benchmark_mode"))
+    arguments.benchmark_mode                     = json["benchmark_mode"                    ].get<std::string>();
+  if (json.contains("benchmark_iterations"))
+    arguments.benchmark_iterations               = json["benchmark_iterations"              ].get<integer>();
+  if (json.contains("benchmark_warmup_iterations"))
+    arguments.benchmark_warmup_iterations        = json["benchmark_warmup_iterations"       ].get<integer>();
+  if (json.contains("checkpoint_rounds"))
+    arguments.checkpoint_rounds                  = json["checkpoint_rounds"                 ].get<integer>();
+  if (json.contains("checkpoint_seconds"))
+    arguments.checkpoint_seconds                 = json["checkpoint_seconds"                ].get<scalar> ();
+  if (json.contains("checkpoint_restart"))
+    arguments.checkpoint_restart                 = json["checkpoint_restart"                ].get<bool>   ();
+  if (json.contains("log_level"))
+    arguments.log_level                          = json["log_level"                         ].get<std::string>();
+  if (json.contains("log_rate_limit"))
+    arguments.log_rate_limit                     = json["log_rate_limit"                    ].get<integer>();
+  if (json.contains("log_aggregate"))
+    arguments.log_aggregate                      = json["log_aggregate"                     ].get<bool>   ();
 
   return arguments;
 }
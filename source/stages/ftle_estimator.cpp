@@ -0,0 +1,216 @@
+#include <dpa/stages/ftle_estimator.hpp>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include <boost/mpi.hpp>
+#include <Eigen/Eigenvalues>
+#include <hdf5.h>
+#include <tbb/tbb.h>
+
+#include <dpa/math/indexing.hpp>
+#include <dpa/stages/uniform_seed_generator.hpp>
+#include <dpa/utility/logger.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+ftle_estimator::ftle_estimator (domain_partitioner* partitioner, const vector3& spacing, const vector3& stride, const std::optional<aabb3>& aabb)
+: partitioner_ (partitioner)
+, grid_spacing_(spacing.array() * stride.array())
+{
+  const vector3 offset = spacing.array() * partitioner_->partitions().at(relative_direction::center).offset.cast<scalar>().array();
+  const vector3 size   = spacing.array() * partitioner_->block_size()                                      .cast<scalar>().array();
+  std::tie(grid_origin_, grid_dimensions_) = uniform_seed_generator::grid(offset, size, grid_spacing_, aabb);
+}
+
+regular_scalar_field_3d ftle_estimator::estimate(const std::vector<particle<vector3, integer>>& particles) const
+{
+  regular_scalar_field_3d ftle {regular_scalar_field_3d::array_type(boost::extents[grid_dimensions_[0]][grid_dimensions_[1]][grid_dimensions_[2]])};
+  ftle.offset  = grid_origin_;
+  ftle.spacing = grid_spacing_;
+  ftle.size    = grid_dimensions_.cast<scalar>().array() * grid_spacing_.array();
+  std::fill_n(ftle.data.data(), ftle.data.num_elements(), std::numeric_limits<scalar>::quiet_NaN());
+
+#ifdef DPA_FTLE_SUPPORT
+  // The original and final positions per seed, with one ghost layer per side, and the integration times per seed.
+  const ivector3 ghosted_dimensions = grid_dimensions_.array() + 2;
+  const vector3  nan                = vector3::Constant(std::numeric_limits<scalar>::quiet_NaN());
+  boost::multi_array<vector3, 3> origins(boost::extents[ghosted_dimensions[0]][ghosted_dimensions[1]][ghosted_dimensions[2]]);
+  boost::multi_array<vector3, 3> flow   (boost::extents[ghosted_dimensions[0]][ghosted_dimensions[1]][ghosted_dimensions[2]]);
+  boost::multi_array<scalar , 3> times  (boost::extents[grid_dimensions_  [0]][grid_dimensions_  [1]][grid_dimensions_  [2]]);
+  std::fill_n(origins.data(), origins.num_elements(), nan);
+  std::fill_n(flow   .data(), flow   .num_elements(), nan);
+  std::fill_n(times  .data(), times  .num_elements(), scalar(0));
+
+  tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
+  {
+    const auto&    particle = particles[index];
+    const ivector3 seed     = ((particle.original_position - grid_origin_).array() / grid_spacing_.array()).round().cast<integer>();
+    if ((seed.array() < 0).any() || (seed.array() >= grid_dimensions_.array()).any())
+      return;
+    origins[seed[0] + 1][seed[1] + 1][seed[2] + 1] = particle.original_position;
+    flow   [seed[0] + 1][seed[1] + 1][seed[2] + 1] = particle.position;
+    times  [seed[0]    ][seed[1]    ][seed[2]    ] = particle.time;
+  });
+
+  // Exchange the faces of the flow map with the neighbors. A face of mismatching size (e.g. due to the seed boundaries) is ignored.
+  {
+    auto  communicator = partitioner_->cartesian_communicator();
+    auto& partitions   = partitioner_->partitions();
+
+    const auto face    = [&] (const integer axis, const integer layer, const auto& function)
+    {
+      const auto first_axis  = (axis + 1) % 3;
+      const auto second_axis = (axis + 2) % 3;
+      ivector3 index;
+      index[axis] = layer;
+      for (index[first_axis] = 1; index[first_axis] <= grid_dimensions_[first_axis]; ++index[first_axis])
+        for (index[second_axis] = 1; index[second_axis] <= grid_dimensions_[second_axis]; ++index[second_axis])
+          function(index);
+    };
+
+    std::vector<boost::mpi::request> requests;
+    std::vector<std::vector<scalar>> outgoing(6);
+    for (auto axis = 0; axis < 3; ++axis)
+      for (auto side : {-1, 1})
+      {
+        const auto direction = relative_direction(side * (axis + 1));
+        if (partitions.find(direction) == partitions.end())
+          continue;
+
+        auto& buffer = outgoing[2 * axis + (side > 0)];
+        face(axis, side < 0 ? 1 : grid_dimensions_[axis], [&] (const ivector3& index)
+        {
+          const auto& origin = origins[index[0]][index[1]][index[2]];
+          const auto& target = flow   [index[0]][index[1]][index[2]];
+          buffer.insert(buffer.end(), {origin[0], origin[1], origin[2], target[0], target[1], target[2]});
+        });
+        requests.push_back(communicator->isend(partitions.at(direction).rank, 2 * axis + (side > 0), buffer));
+      }
+    for (auto axis = 0; axis < 3; ++axis)
+      for (auto side : {-1, 1})
+      {
+        const auto direction = relative_direction(side * (axis + 1));
+        if (partitions.find(direction) == partitions.end())
+          continue;
+
+        // The negative neighbor sends its positive face and vice versa.
+        std::vector<scalar> buffer;
+        communicator->recv(partitions.at(direction).rank, 2 * axis + (side < 0), buffer);
+        if (buffer.size() != std::size_t(6 * grid_dimensions_[(axis + 1) % 3] * grid_dimensions_[(axis + 2) % 3]))
+          continue;
+
+        auto iterator = buffer.begin();
+        face(axis, side < 0 ? 0 : grid_dimensions_[axis] + 1, [&] (const ivector3& index)
+        {
+          origins[index[0]][index[1]][index[2]] = vector3(iterator[0], iterator[1], iterator[2]);
+          flow   [index[0]][index[1]][index[2]] = vector3(iterator[3], iterator[4], iterator[5]);
+          iterator += 6;
+        });
+      }
+    for (auto& request : requests)
+      request.wait();
+  }
+
+  const auto available = [&] (const ivector3& index) { return !std::isnan(origins[index[0]][index[1]][index[2]][0]); };
+  tbb::parallel_for(std::size_t(0), std::size_t(grid_dimensions_.prod()), std::size_t(1), [&] (const std::size_t linear_index)
+  {
+    const ivector3 seed  = unravel_index(linear_index, grid_dimensions_);
+    const ivector3 index = seed.array() + 1;
+    const scalar   time  = times[seed[0]][seed[1]][seed[2]];
+    if (!available(index) || time == scalar(0))
+      return;
+
+    // Central differences of the flow map, one-sided where a neighboring seed is unavailable.
+    matrix3 jacobian;
+    for (auto dimension = 0; dimension < 3; ++dimension)
+    {
+      ivector3 lower = index, upper = index;
+      --lower[dimension];
+      ++upper[dimension];
+      if (!available(lower)) lower = index;
+      if (!available(upper)) upper = index;
+      if (lower == upper)
+        return;
+
+      jacobian.col(dimension) =
+        (flow   [upper[0]][upper[1]][upper[2]]            - flow   [lower[0]][lower[1]][lower[2]]           ) /
+        (origins[upper[0]][upper[1]][upper[2]][dimension] - origins[lower[0]][lower[1]][lower[2]][dimension]);
+    }
+
+    const matrix3 cauchy_green = jacobian.transpose() * jacobian;
+    const scalar  eigenvalue   = Eigen::SelfAdjointEigenSolver<matrix3>(cauchy_green, Eigen::EigenvaluesOnly).eigenvalues().maxCoeff();
+    ftle.data[seed[0]][seed[1]][seed[2]] = std::log(std::sqrt(eigenvalue)) / std::abs(time);
+  });
+#else
+  logger::instance().warning("FTLE is not estimated since original positions are unavailable. Declare DPA_FTLE_SUPPORT and rebuild.");
+#endif
+
+  return ftle;
+}
+void                    ftle_estimator::save    (const regular_scalar_field_3d& ftle, const std::string& filepath, const std::string& dataset_name) const
+{
+  auto communicator = partitioner_->cartesian_communicator();
+
+  // The global grid is the concatenation of the grids of the ranks along each axis of the cartesian communicator.
+  const auto& coordinates = partitioner_->partitions().at(relative_direction::center).multi_rank;
+  std::array<integer, 6> local {coordinates[0], coordinates[1], coordinates[2], grid_dimensions_[0], grid_dimensions_[1], grid_dimensions_[2]};
+  std::vector<integer>   all   (6 * communicator->size());
+  MPI_Allgather(local.data(), 6, MPI_INT, all.data(), 6, MPI_INT, *communicator);
+
+  std::array<hsize_t, 3> global_dimensions {0, 0, 0};
+  std::array<hsize_t, 3> offset            {0, 0, 0};
+  for (auto rank = 0; rank < communicator->size(); ++rank)
+  {
+    const auto other = all.data() + 6 * rank;
+    for (auto axis = 0; axis < 3; ++axis)
+    {
+      if (other[(axis + 1) % 3] != coordinates[(axis + 1) % 3] || other[(axis + 2) % 3] != coordinates[(axis + 2) % 3])
+        continue;
+      global_dimensions[axis] += other[3 + axis];
+      if (other[axis] < coordinates[axis])
+        offset[axis] += other[3 + axis];
+    }
+  }
+
+  // The origin of the rank at the minimum coordinates.
+  vector3 origin = ftle.offset;
+  MPI_Allreduce(MPI_IN_PLACE, origin.data(), 3, MPI_FLOAT, MPI_MIN, *communicator);
+
+  const auto access_property = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_mpio(access_property, *partitioner_->communicator(), MPI_INFO_NULL);
+  const auto file            = H5Fcreate(filepath.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, access_property);
+  H5Pclose(access_property);
+
+  const auto space           = H5Screate_simple(3, global_dimensions.data(), nullptr);
+  const auto dataset         = H5Dcreate2(file, dataset_name.c_str(), H5T_NATIVE_FLOAT, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+  const std::array<hsize_t, 3> local_dimensions {hsize_t(grid_dimensions_[0]), hsize_t(grid_dimensions_[1]), hsize_t(grid_dimensions_[2])};
+  const auto memspace        = H5Screate_simple(3, local_dimensions.data(), nullptr);
+  const auto transfer        = H5Pcreate(H5P_DATASET_XFER);
+  H5Pset_dxpl_mpio   (transfer, H5FD_MPIO_COLLECTIVE);
+  H5Sselect_hyperslab(space, H5S_SELECT_SET, offset.data(), nullptr, local_dimensions.data(), nullptr);
+  H5Dwrite           (dataset, H5T_NATIVE_FLOAT, memspace, space, transfer, ftle.data.data());
+
+  const std::array<hsize_t, 1> attribute_dimensions {3};
+  const auto attribute_space = H5Screate_simple(1, attribute_dimensions.data(), nullptr);
+  for (const auto& attribute : {std::make_pair("origin", origin), std::make_pair("spacing", grid_spacing_)})
+  {
+    const auto handle = H5Acreate2(dataset, attribute.first, H5T_NATIVE_FLOAT, attribute_space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(handle, H5T_NATIVE_FLOAT, attribute.second.data());
+    H5Aclose(handle);
+  }
+
+  H5Sclose(attribute_space);
+  H5Pclose(transfer);
+  H5Sclose(memspace);
+  H5Dclose(dataset);
+  H5Sclose(space);
+  H5Fclose(file);
+}
+}
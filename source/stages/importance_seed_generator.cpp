@@ -0,0 +1,100 @@
+#include <dpa/stages/importance_seed_generator.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+#include <tbb/tbb.h>
+
+#include <dpa/math/indexing.hpp>
+#include <dpa/math/philox.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+scalar                                            importance_seed_generator::velocity_magnitude (const regular_vector_field_3d& vector_field, const ivector3& index)
+{
+  return vector_field.data[index[0]][index[1]][index[2]].norm();
+}
+scalar                                            importance_seed_generator::vorticity_magnitude(const regular_vector_field_3d& vector_field, const ivector3& index)
+{
+  // Central differences, one-sided at the boundaries of the (ghosted) field.
+  matrix3 jacobian; // jacobian(i, j) = d v_i / d x_j
+  for (auto dimension = 0; dimension < 3; ++dimension)
+  {
+    ivector3 lower = index, upper = index;
+    lower[dimension] = std::max(index[dimension] - 1, 0);
+    upper[dimension] = std::min(index[dimension] + 1, integer(vector_field.data.shape()[dimension]) - 1);
+    if (lower[dimension] == upper[dimension])
+    {
+      jacobian.col(dimension).setZero();
+      continue;
+    }
+    jacobian.col(dimension) = 
+      (vector_field.data[upper[0]][upper[1]][upper[2]] - vector_field.data[lower[0]][lower[1]][lower[2]]) / 
+      ((upper[dimension] - lower[dimension]) * vector_field.spacing[dimension]);
+  }
+  return vector3(
+    jacobian(2, 1) - jacobian(1, 2),
+    jacobian(0, 2) - jacobian(2, 0),
+    jacobian(1, 0) - jacobian(0, 1)).norm();
+}
+importance_seed_generator::density_function       importance_seed_generator::density            (const std::string& name)
+{
+  if (name == "vorticity_magnitude")
+    return vorticity_magnitude;
+  return velocity_magnitude;
+}
+
+std::vector<particle<vector3, integer>>           importance_seed_generator::generate           (const regular_vector_field_3d& vector_field, vector3 offset, vector3 size, integer count, integer iterations, integer process_index, const density_function& density, std::optional<aabb3> aabb, std::uint32_t seed)
+{
+  if (aabb)
+  {
+    auto intersection = aabb->intersection(aabb3(offset, offset + size));
+    if (!intersection.isEmpty())
+    {
+      offset = intersection.min  ();
+      size   = intersection.sizes();
+    }
+  }
+
+  // The cells overlapping [offset, offset + size]. A cell requires its upper corner within the field.
+  const ivector3 shape      (vector_field.data.shape()[0], vector_field.data.shape()[1], vector_field.data.shape()[2]);
+  const ivector3 first_cell = ((offset        - vector_field.offset).array() / vector_field.spacing.array()).floor().cast<integer>().max(0);
+  const ivector3 last_cell  = ((offset + size - vector_field.offset).array() / vector_field.spacing.array()).ceil ().cast<integer>().min(shape.array() - 1);
+  const ivector3 cells      = (last_cell - first_cell).cwiseMax(0);
+
+  std::vector<double> cumulative_densities(cells.prod());
+  tbb::parallel_for(std::size_t(0), cumulative_densities.size(), std::size_t(1), [&] (const std::size_t index)
+  {
+    cumulative_densities[index] = std::max(density(vector_field, first_cell + unravel_index(index, cells)), scalar(0));
+  });
+  std::partial_sum(cumulative_densities.begin(), cumulative_densities.end(), cumulative_densities.begin());
+
+  // A uniform density in the absence of features.
+  if (!cumulative_densities.empty() && cumulative_densities.back() <= 0.0)
+    std::iota(cumulative_densities.begin(), cumulative_densities.end(), 1.0);
+
+  const auto total = cumulative_densities.empty() ? 0.0 : cumulative_densities.back();
+  const auto key   = philox::key_type {seed, std::uint32_t(process_index)};
+
+  std::vector<particle<vector3, integer>> particles(total > 0.0 ? count : 0);
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, particles.size()), [&] (const tbb::blocked_range<std::size_t>& range)
+  {
+    for (auto index = range.begin(); index != range.end(); ++index)
+    {
+      // The third counter word separates the stream from the one of the uniform random seeds.
+      const auto    random   = philox::generate({std::uint32_t(index), std::uint32_t(std::uint64_t(index) >> 32), 2, 0}, key);
+      const auto    target   = (double(random[0]) + 0.5) / 4294967296.0 * total;
+      const auto    cell     = std::size_t(std::upper_bound(cumulative_densities.begin(), cumulative_densities.end() - 1, target) - cumulative_densities.begin());
+      const vector3 jitter   (philox::to_unit(random[1]), philox::to_unit(random[2]), philox::to_unit(random[3]));
+      const vector3 position = (vector_field.offset.array() + vector_field.spacing.array() * ((first_cell + unravel_index(cell, cells)).cast<scalar>() + jitter).array())
+        .max(offset.array()).min((offset + size).array());
+
+      particles[index] = particle<vector3, integer>(position, iterations, process_index);
+    }
+  });
+  return particles;
+}
+}
@@ -2,12 +2,17 @@
 
 #include <filesystem>
 #include <fstream>
-#include <variant>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/mpi.hpp>
+#include <tbb/concurrent_queue.h>
 #include <tbb/tbb.h>
 
+#include <dpa/utility/curve_codec.hpp>
 #include <dpa/utility/xdmf.hpp>
 
 #undef min
@@ -15,10 +20,19 @@
 
 namespace dpa
 {
-integral_curve_saver::integral_curve_saver (domain_partitioner* partitioner, const std::string& filepath) 
+integral_curve_saver::integral_curve_saver (domain_partitioner* partitioner, const std::string& filepath, const std::string& topology, const std::string& vertex_encoding, const vector3& origin, const scalar precision)
 : partitioner_(partitioner)
 , filepath_   (std::filesystem::path(filepath).replace_extension(".rank_" + std::to_string(partitioner_->cartesian_communicator()->rank()) + ".h5").string())
+, origin_     (origin)
+, precision_  (precision)
 {
+  if      (topology == "mixed"  ) topology_ = topology::mixed;
+  else if (topology == "offsets") topology_ = topology::offsets;
+  else                            topology_ = topology::segments;
+
+  if   (vertex_encoding == "quantized_delta") vertex_encoding_ = vertex_encoding::quantized_delta;
+  else                                        vertex_encoding_ = vertex_encoding::raw;
+
   file_ = H5Fcreate(filepath_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
 }
 integral_curve_saver::~integral_curve_saver()
@@ -26,96 +40,240 @@ integral_curve_saver::~integral_curve_saver()
   H5Fclose(file_);
 }
 
-void integral_curve_saver::save_integral_curves(const integral_curves_3d& integral_curves, bool use_64_bit_indices)
+void                                 integral_curve_saver::save_integral_curves(const integral_curves_3d& integral_curves, const integral_curve_spiller* spiller)
 {
-  std::vector<std::string> xdmfs;
+  // HDF5 is not thread-safe, hence the rounds are prepared in parallel and handed to a single thread which owns all HDF5 calls.
+  // The queue is bounded to limit the number of prepared rounds held in memory while the writer catches up. The spilled rounds are
+  // loaded and prepared in order after the rounds in memory, each once the previously loaded one is written, hence at most one
+  // spilled round is held in memory at a time. Loading them within the parallel loop would block its workers on the token, which
+  // the preparation of the loaded round (itself parallel) may then steal.
+  tbb::concurrent_bounded_queue<std::optional<prepared_round>> queue;
+  queue.set_capacity(tbb::this_task_arena::max_concurrency());
+  tbb::concurrent_bounded_queue<bool>                          loaded;
+  loaded.set_capacity(1);
 
-  for (auto curve_index = 0; curve_index < integral_curves.size(); ++curve_index)
-  //tbb::parallel_for(std::size_t(0), integral_curves.size(), std::size_t(1), [&] (const std::size_t curve_index)
+  std::vector<std::string> xdmfs(integral_curves.size());
+  std::thread writer([&] ()
   {
-    auto& vertices = integral_curves[curve_index];
+    std::optional<prepared_round> round;
+    for (queue.pop(round); round; queue.pop(round))
+    {
+      write_round(*round);
+      xdmfs[round->index] = std::move(round->xdmf);
+      if (round->loaded_curves)
+      {
+        round->loaded_curves.reset();
+        bool token;
+        loaded.pop(token);
+      }
+    }
+  });
 
-    if (vertices.empty())
-      continue;
+  // The writer is stopped and joined before an exception of the preparation or the loading propagates.
+  try
+  {
+    tbb::parallel_for(std::size_t(0), integral_curves.size(), std::size_t(1), [&] (const std::size_t index)
+    {
+      // The spilled rounds remain as empty entries.
+      if (!integral_curves[index].vertices.empty())
+        queue.push(prepare_round(integral_curves[index], index));
+    });
 
-    std::vector<std::array<std::uint8_t, 3>> colors(vertices.size(), std::array<std::uint8_t, 3>{0, 0, 0});
-    tbb::parallel_for(std::size_t(0), vertices.size(), std::size_t(1), [&] (const std::size_t vertex_index)
+    for (std::size_t index = 0; spiller && index < integral_curves.size(); ++index)
     {
-      if (vertices[vertex_index] != terminal_value<vector3>())
-      {
-        vector3 tangent;
-        if (vertex_index     > 1               && vertices[vertex_index - 1] != terminal_value<vector3>())
-          tangent = (vertices[vertex_index    ] - vertices[vertex_index - 1]).normalized();
-        if (vertex_index + 1 < vertices.size() && vertices[vertex_index + 1] != terminal_value<vector3>())
-          tangent = ((tangent + (vertices[vertex_index + 1] - vertices[vertex_index]).normalized()) / scalar(2)).normalized();
+      if (!spiller->spilled(index))
+        continue;
 
-        colors[vertex_index] = std::array<std::uint8_t, 3>
-        {
-          std::uint8_t(255 * std::abs(tangent[0])),
-          std::uint8_t(255 * std::abs(tangent[1])),
-          std::uint8_t(255 * std::abs(tangent[2]))
-        };
+      loaded.push(true);
+      const auto curves   = std::make_shared<const compressed_integral_curves<vector3>>(spiller->load(index));
+      if (curves->vertices.empty())
+      {
+        bool token;
+        loaded.pop(token);
+        continue;
       }
-    });
+      auto       round    = prepare_round(*curves, index);
+      round.loaded_curves = curves;
+      queue.push(std::move(round));
+    }
+  }
+  catch (...)
+  {
+    queue.push(std::nullopt);
+    writer.join();
+    throw;
+  }
+  queue.push(std::nullopt);
+  writer.join();
 
-    std::variant<std::vector<std::uint32_t>, std::vector<std::uint64_t>> indices;
-    if (use_64_bit_indices)
-      indices = std::vector<std::uint64_t>(2 * vertices.size(), std::numeric_limits<std::uint64_t>::max());
-    else
-      indices = std::vector<std::uint32_t>(2 * vertices.size(), std::numeric_limits<std::uint32_t>::max());
+  if (topology_ == topology::offsets || vertex_encoding_ == vertex_encoding::quantized_delta)
+    return;
 
-    std::visit([&] (auto& cast_indices) 
+  std::ofstream stream(filepath_ + ".xdmf");
+  stream << xdmf_header << std::accumulate(xdmfs.begin(), xdmfs.end(), std::string("")) << xdmf_footer;
+}
+
+integral_curve_saver::prepared_round integral_curve_saver::prepare_round       (const compressed_integral_curves<vector3>& curves, const std::size_t index) const
+{
+  prepared_round round {index, &curves};
+
+  auto& vertices = curves.vertices;
+
+  round.colors.resize(vertices.size(), std::array<std::uint8_t, 3>{0, 0, 0});
+  tbb::parallel_for(std::size_t(0), curves.curve_count(), std::size_t(1), [&] (const std::size_t curve_index)
+  {
+    const auto begin = curves.offsets[curve_index    ];
+    const auto end   = curves.offsets[curve_index + 1];
+    for (auto vertex_index = begin; vertex_index < end; ++vertex_index)
     {
-      tbb::parallel_for(std::size_t(0), vertices.size() - 1, std::size_t(1), [&] (const std::size_t vertex_index)
+      vector3 tangent;
+      if (vertex_index     > begin)
+        tangent = (vertices[vertex_index    ] - vertices[vertex_index - 1]).normalized();
+      if (vertex_index + 1 < end  )
+        tangent = ((tangent + (vertices[vertex_index + 1] - vertices[vertex_index]).normalized()) / scalar(2)).normalized();
+
+      round.colors[vertex_index] = std::array<std::uint8_t, 3>
       {
-        if (vertices[vertex_index] != terminal_value<vector3>() && vertices[vertex_index + 1] != terminal_value<vector3>())
+        std::uint8_t(255 * std::abs(tangent[0])),
+        std::uint8_t(255 * std::abs(tangent[1])),
+        std::uint8_t(255 * std::abs(tangent[2]))
+      };
+    }
+  });
+
+  // Every curve contains at least its seed, hence curve i has offsets[i + 1] - offsets[i] - 1 segments, the first of which is segment offsets[i] - i.
+  const auto curve_count        = curves.curve_count();
+  const auto segment_count      = vertices.size() - curve_count;
+  const auto use_64_bit_indices = vertices.size() > std::numeric_limits<std::uint32_t>::max();
+  const auto index_count        = topology_ == topology::segments ? 2 * segment_count : topology_ == topology::mixed ? vertices.size() + 2 * curve_count : 0;
+
+  if (use_64_bit_indices)
+    round.indices = std::vector<std::uint64_t>(index_count);
+  else
+    round.indices = std::vector<std::uint32_t>(index_count);
+
+  std::visit([&] (auto& cast_indices)
+  {
+    if      (topology_ == topology::segments)
+    {
+      tbb::parallel_for(std::size_t(0), curve_count, std::size_t(1), [&] (const std::size_t curve_index)
+      {
+        const auto begin         = curves.offsets[curve_index    ];
+        const auto end           = curves.offsets[curve_index + 1];
+        const auto segment_index = begin - curve_index;
+        for (auto vertex_index = begin; vertex_index + 1 < end; ++vertex_index)
         {
-          cast_indices[2 * vertex_index    ] = vertex_index;
-          cast_indices[2 * vertex_index + 1] = vertex_index + 1;
+          cast_indices[2 * (segment_index + vertex_index - begin)    ] = vertex_index;
+          cast_indices[2 * (segment_index + vertex_index - begin) + 1] = vertex_index + 1;
         }
       });
-      cast_indices.erase(std::remove(cast_indices.begin(), cast_indices.end(), use_64_bit_indices ? std::numeric_limits<std::uint64_t>::max() : std::numeric_limits<std::uint32_t>::max()), cast_indices.end());
-    }, indices);
-
-    const auto vertex_element_count = hsize_t(3 * vertices.size());
-    const auto color_element_count  = hsize_t(3 * vertices.size());
-    const auto index_count          = hsize_t(use_64_bit_indices ? std::get<std::vector<std::uint64_t>>(indices).size() : std::get<std::vector<std::uint32_t>>(indices).size());
-    const auto vertices_name        = "vertices_" + std::to_string(curve_index);
-    const auto colors_name          = "colors_"   + std::to_string(curve_index);
-    const auto indices_name         = "indices_"  + std::to_string(curve_index);
-
-    const auto vertices_space       = H5Screate_simple(1, &vertex_element_count, nullptr);
-    const auto colors_space         = H5Screate_simple(1, &color_element_count , nullptr);
-    const auto indices_space        = H5Screate_simple(1, &index_count         , nullptr);
-    const auto vertices_dataset     = H5Dcreate2(file_, vertices_name.c_str(), H5T_NATIVE_FLOAT                                          , vertices_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    const auto colors_dataset       = H5Dcreate2(file_, colors_name  .c_str(), H5T_NATIVE_UINT8                                          , colors_space  , H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    const auto indices_dataset      = H5Dcreate2(file_, indices_name .c_str(), use_64_bit_indices ? H5T_NATIVE_UINT64 : H5T_NATIVE_UINT32, indices_space , H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    H5Dwrite(vertices_dataset, H5T_NATIVE_FLOAT                                          , vertices_space, vertices_space, H5P_DEFAULT, vertices.data()->data());
-    H5Dwrite(colors_dataset  , H5T_NATIVE_UINT8                                          , colors_space  , colors_space  , H5P_DEFAULT, colors  .data()->data());
-    H5Dwrite(indices_dataset , use_64_bit_indices ? H5T_NATIVE_UINT64 : H5T_NATIVE_UINT32, indices_space , indices_space , H5P_DEFAULT, use_64_bit_indices ? reinterpret_cast<void*>(std::get<std::vector<std::uint64_t>>(indices).data()) : std::get<std::vector<std::uint32_t>>(indices).data());
-
-    H5Sclose(vertices_space  );
-    H5Sclose(colors_space    );
-    H5Sclose(indices_space   );
-    H5Dclose(vertices_dataset);
-    H5Dclose(colors_dataset  );
-    H5Dclose(indices_dataset );
-    
-    auto& xdmf = xdmfs.emplace_back(xdmf_body);
-    boost::replace_all(xdmf, "$GRID_NAME"            , "grid_" + std::to_string(curve_index));
-    boost::replace_all(xdmf, "$POLYLINE_COUNT"       , std::to_string(index_count / 2));
-    boost::replace_all(xdmf, "$FILEPATH"             , std::filesystem::path(filepath_).filename().string());
-    boost::replace_all(xdmf, "$INDICES_DATASET_NAME" , indices_name );
-    boost::replace_all(xdmf, "$VERTICES_DATASET_NAME", vertices_name);
-    boost::replace_all(xdmf, "$COLORS_DATASET_NAME"  , colors_name  );
-    boost::replace_all(xdmf, "$INDEX_ARRAY_SIZE"     , std::to_string(index_count));
-    boost::replace_all(xdmf, "$INDEX_PRECISION"      , use_64_bit_indices ? "8" : "4");
-    boost::replace_all(xdmf, "$VERTEX_ARRAY_SIZE"    , std::to_string(vertex_element_count));
-  //});
+    }
+    else if (topology_ == topology::mixed)
+    {
+      // Curve i starts at offsets[i] + 2 * i, with the XDMF Polyline type (2) and its vertex count.
+      tbb::parallel_for(std::size_t(0), curve_count, std::size_t(1), [&] (const std::size_t curve_index)
+      {
+        const auto begin = curves.offsets[curve_index    ];
+        const auto end   = curves.offsets[curve_index + 1];
+        auto       entry = cast_indices.begin() + begin + 2 * curve_index;
+        *entry++ = 2;
+        *entry++ = end - begin;
+        std::iota(entry, entry + (end - begin), begin);
+      });
+    }
+  }, round.indices);
+
+  if (vertex_encoding_ == vertex_encoding::quantized_delta)
+    round.encoded_vertices = curve_codec::encode(curves, origin_, precision_);
+
+  // Offsets and encoded vertices can not be described by XDMF. Decoding restores the raw layout described by it.
+  if (topology_ == topology::offsets || vertex_encoding_ == vertex_encoding::quantized_delta)
+    return round;
+
+  round.xdmf = xdmf_body;
+  boost::replace_all(round.xdmf, "$GRID_NAME"            , "grid_" + std::to_string(index));
+  boost::replace_all(round.xdmf, "$TOPOLOGY_TYPE"        , topology_ == topology::mixed ? "Mixed" : "Polyline");
+  boost::replace_all(round.xdmf, "$NODES_PER_ELEMENT"    , topology_ == topology::mixed ? ""      : " NodesPerElement=\"2\"");
+  boost::replace_all(round.xdmf, "$ELEMENT_COUNT"        , std::to_string(topology_ == topology::mixed ? curve_count : segment_count));
+  boost::replace_all(round.xdmf, "$FILEPATH"             , std::filesystem::path(filepath_).filename().string());
+  boost::replace_all(round.xdmf, "$INDICES_DATASET_NAME" , "indices_"  + std::to_string(index));
+  boost::replace_all(round.xdmf, "$VERTICES_DATASET_NAME", "vertices_" + std::to_string(index));
+  boost::replace_all(round.xdmf, "$COLORS_DATASET_NAME"  , "colors_"   + std::to_string(index));
+  boost::replace_all(round.xdmf, "$INDEX_ARRAY_SIZE"     , std::to_string(index_count));
+  boost::replace_all(round.xdmf, "$INDEX_PRECISION"      , use_64_bit_indices ? "8" : "4");
+  boost::replace_all(round.xdmf, "$VERTEX_ARRAY_SIZE"    , std::to_string(3 * vertices.size()));
+  return round;
+}
+void                                 integral_curve_saver::write_round         (const prepared_round& round)
+{
+  const auto& curves               = *round.curves;
+  const auto  vertex_element_count = hsize_t(vertex_encoding_ == vertex_encoding::quantized_delta ? round.encoded_vertices.size() : 3 * curves.vertices.size());
+  const auto  vertex_type          = vertex_encoding_ == vertex_encoding::quantized_delta ? H5T_NATIVE_UINT8 : H5T_NATIVE_FLOAT;
+  const auto  vertex_data          = vertex_encoding_ == vertex_encoding::quantized_delta ? static_cast<const void*>(round.encoded_vertices.data()) : curves.vertices.data()->data();
+  const auto  color_element_count  = hsize_t(3 * curves.vertices.size());
+  const auto  vertices_name        = "vertices_" + std::to_string(round.index);
+  const auto  colors_name          = "colors_"   + std::to_string(round.index);
+
+  const auto  vertices_space       = H5Screate_simple(1, &vertex_element_count, nullptr);
+  const auto  colors_space         = H5Screate_simple(1, &color_element_count , nullptr);
+  const auto  vertices_dataset     = H5Dcreate2(file_, vertices_name.c_str(), vertex_type     , vertices_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  const auto  colors_dataset       = H5Dcreate2(file_, colors_name  .c_str(), H5T_NATIVE_UINT8, colors_space  , H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+  H5Dwrite(vertices_dataset, vertex_type     , vertices_space, vertices_space, H5P_DEFAULT, vertex_data);
+  H5Dwrite(colors_dataset  , H5T_NATIVE_UINT8, colors_space  , colors_space  , H5P_DEFAULT, round.colors.data()->data());
+
+  if (topology_ != topology::offsets)
+  {
+    const auto use_64_bit_indices = std::holds_alternative<std::vector<std::uint64_t>>(round.indices);
+    const auto index_type         = use_64_bit_indices ? H5T_NATIVE_UINT64 : H5T_NATIVE_UINT32;
+    const auto index_data         = std::visit([ ] (const auto& cast_indices) { return static_cast<const void*>(cast_indices.data()); }, round.indices);
+    const auto index_count        = hsize_t(std::visit([ ] (const auto& cast_indices) { return cast_indices.size(); }, round.indices));
+    const auto indices_name       = "indices_" + std::to_string(round.index);
+    const auto indices_space      = H5Screate_simple(1, &index_count, nullptr);
+    const auto indices_dataset    = H5Dcreate2      (file_, indices_name.c_str(), index_type, indices_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    H5Dwrite(indices_dataset, index_type, indices_space, indices_space, H5P_DEFAULT, index_data);
+
+    H5Dclose(indices_dataset);
+    H5Sclose(indices_space  );
   }
-  
-  std::ofstream stream(filepath_ + ".xdmf");
-  stream << xdmf_header << std::accumulate(xdmfs.begin(), xdmfs.end(), std::string("")) << xdmf_footer;
+
+  // The offsets delimit the curves in the offsets topology and are required by the decoder of the encoded vertices.
+  if (topology_ == topology::offsets || vertex_encoding_ == vertex_encoding::quantized_delta)
+  {
+    const auto offsets_name    = "offsets_" + std::to_string(round.index);
+    const auto offset_count    = hsize_t(curves.offsets.size());
+    const auto offsets         = std::vector<std::uint64_t>(curves.offsets.begin(), curves.offsets.end());
+    const auto offsets_space   = H5Screate_simple(1, &offset_count, nullptr);
+    const auto offsets_dataset = H5Dcreate2      (file_, offsets_name.c_str(), H5T_NATIVE_UINT64, offsets_space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    H5Dwrite(offsets_dataset, H5T_NATIVE_UINT64, offsets_space, offsets_space, H5P_DEFAULT, offsets.data());
+
+    H5Dclose(offsets_dataset);
+    H5Sclose(offsets_space  );
+  }
+
+  if (vertex_encoding_ == vertex_encoding::quantized_delta)
+  {
+    // The decoder requires the origin and the precision; see curve_codec::decode.
+    const auto origin_count        = hsize_t(3);
+    const auto scalar_space        = H5Screate       (H5S_SCALAR);
+    const auto origin_space        = H5Screate_simple(1, &origin_count, nullptr);
+    const auto origin_attribute    = H5Acreate2      (vertices_dataset, "origin"   , H5T_NATIVE_FLOAT, origin_space, H5P_DEFAULT, H5P_DEFAULT);
+    const auto precision_attribute = H5Acreate2      (vertices_dataset, "precision", H5T_NATIVE_FLOAT, scalar_space, H5P_DEFAULT, H5P_DEFAULT);
+
+    H5Awrite(origin_attribute   , H5T_NATIVE_FLOAT, origin_.data());
+    H5Awrite(precision_attribute, H5T_NATIVE_FLOAT, &precision_);
+
+    H5Aclose(origin_attribute   );
+    H5Aclose(precision_attribute);
+    H5Sclose(scalar_space       );
+    H5Sclose(origin_space       );
+  }
+
+  H5Sclose(vertices_space  );
+  H5Sclose(colors_space    );
+  H5Dclose(vertices_dataset);
+  H5Dclose(colors_dataset  );
 }
 }
\ No newline at end of file
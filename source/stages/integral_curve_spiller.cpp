@@ -0,0 +1,102 @@
+#include <dpa/stages/integral_curve_spiller.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <dpa/utility/logger.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+std::size_t                         integral_curve_spiller::memory        (const compressed_integral_curves<vector3>& curves)
+{
+  return curves.vertices.size() * sizeof(vector3) + curves.offsets.size() * sizeof(std::size_t);
+}
+std::size_t                         integral_curve_spiller::memory        (const integral_curves_3d&                  integral_curves)
+{
+  std::size_t memory = 0;
+  for (const auto& curves : integral_curves)
+    memory += integral_curve_spiller::memory(curves);
+  return memory;
+}
+
+integral_curve_spiller::integral_curve_spiller (domain_partitioner* partitioner, const std::string& directory, const std::string& filepath, const std::size_t threshold)
+: partitioner_(partitioner)
+, filepath_   ((std::filesystem::path(directory) / std::filesystem::path(filepath).filename().replace_extension(".rank_" + std::to_string(partitioner_->cartesian_communicator()->rank()) + ".spill")).string())
+, threshold_  (threshold)
+{
+  std::ofstream(filepath_, std::ios::binary | std::ios::trunc);
+}
+integral_curve_spiller::~integral_curve_spiller()
+{
+  std::error_code error;
+  if (!filepath_.empty())
+    std::filesystem::remove(filepath_, error);
+}
+
+std::size_t                         integral_curve_spiller::spill         (integral_curves_3d& integral_curves)
+{
+  if (failed_ || memory(integral_curves) <= threshold_)
+    return 0;
+
+  entries_.resize(integral_curves.size());
+
+  std::ofstream stream(filepath_, std::ios::binary | std::ios::app);
+  std::size_t   released = 0;
+  for (std::size_t round = 0; round < integral_curves.size(); ++round)
+  {
+    auto& curves = integral_curves[round];
+    if (curves.offsets.empty())
+      continue;
+
+    const entry round_entry {size_, curves.vertices.size(), curves.offsets.size()};
+    stream.write(reinterpret_cast<const char*>(curves.vertices.data()), std::streamsize(round_entry.vertex_count * sizeof(vector3    )));
+    stream.write(reinterpret_cast<const char*>(curves.offsets .data()), std::streamsize(round_entry.offset_count * sizeof(std::size_t)));
+    stream.flush();
+    if (!stream)
+    {
+      // The partially written round is left unreferenced.
+      failed_ = true;
+      logger::instance().warning("Failed to spill the integral curves to ", filepath_, ". Retaining the remaining curves in memory.");
+      break;
+    }
+
+    released       += memory(curves);
+    size_          += round_entry.vertex_count * sizeof(vector3) + round_entry.offset_count * sizeof(std::size_t);
+    entries_[round] = round_entry;
+    curves          = compressed_integral_curves<vector3>();
+  }
+
+  logger::instance().debug("Spilled ", released, " bytes of integral curves to ", filepath_);
+  return released;
+}
+bool                                integral_curve_spiller::spilled       (const std::size_t round) const
+{
+  return round < entries_.size() && entries_[round].offset_count > 0;
+}
+compressed_integral_curves<vector3> integral_curve_spiller::load          (const std::size_t round) const
+{
+  const auto& round_entry = entries_.at(round);
+
+  compressed_integral_curves<vector3> curves;
+  curves.vertices.resize(round_entry.vertex_count);
+  curves.offsets .resize(round_entry.offset_count);
+
+  std::ifstream stream(filepath_, std::ios::binary);
+  stream.seekg(std::streamoff(round_entry.position));
+  stream.read(reinterpret_cast<char*>(curves.vertices.data()), std::streamsize(round_entry.vertex_count * sizeof(vector3    )));
+  stream.read(reinterpret_cast<char*>(curves.offsets .data()), std::streamsize(round_entry.offset_count * sizeof(std::size_t)));
+  if (!stream)
+    throw std::runtime_error("Failed to load the spilled integral curves of round " + std::to_string(round) + " from " + filepath_ + ".");
+  return curves;
+}
+
+std::size_t                         integral_curve_spiller::spilled_memory() const
+{
+  return std::size_t(size_);
+}
+}
@@ -1,29 +1,46 @@
 #include <dpa/stages/particle_advector.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <numeric>
 #include <optional>
+#include <utility>
 
 #include <boost/serialization/vector.hpp>
 #include <boost/mpi.hpp>
 #include <tbb/tbb.h>
 
+#include <dpa/utility/logger.hpp>
+
 #undef min
 #undef max
 
 namespace dpa
 {
-particle_advector::particle_advector(domain_partitioner* partitioner, const integer particles_per_round, const std::string& load_balancer, const std::string& integrator, const scalar step_size, const bool gather_particles, const bool record)
+particle_advector::particle_advector(domain_partitioner* partitioner, const integer particles_per_round, const std::string& load_balancer, const std::string& integrator, const scalar step_size, const bool gather_particles, const bool record, const curve_decimator<vector3>& decimator, const termination_criteria& termination, const integer handoff_batch_size, const std::string& scheduling, const std::size_t round_memory_budget)
 : partitioner_        (partitioner)
 , particles_per_round_(particles_per_round)
 , step_size_          (step_size)
 , gather_particles_   (gather_particles)
 , record_             (record)
+, decimator_          (decimator)
+, termination_        (termination)
+, handoff_batch_size_ (handoff_batch_size)
+, round_memory_budget_(round_memory_budget)
+, decimators_         (decimator)
 {
   if      (load_balancer == "diffuse_constant")                       load_balancer_ = load_balancer::diffuse_constant;
   else if (load_balancer == "diffuse_lesser_average")                 load_balancer_ = load_balancer::diffuse_lesser_average;
   else if (load_balancer == "diffuse_greater_limited_lesser_average") load_balancer_ = load_balancer::diffuse_greater_limited_lesser_average;
   else                                                                load_balancer_ = load_balancer::none;
 
+  if      (scheduling == "fifo"                   ) scheduling_ = scheduling::fifo;
+  else if (scheduling == "longest_remaining_first") scheduling_ = scheduling::longest_remaining_first;
+  else if (scheduling == "age_priority"           ) scheduling_ = scheduling::age_priority;
+  else                                              scheduling_ = scheduling::lifo;
+
   if      (integrator == "euler"                       ) integrator_ = euler_integrator                       <vector3>();
   else if (integrator == "modified_midpoint"           ) integrator_ = modified_midpoint_integrator           <vector3>();
   else if (integrator == "runge_kutta_4"               ) integrator_ = runge_kutta_4_integrator               <vector3>();
@@ -46,8 +63,7 @@ particle_advector::output     particle_advector::advect                  (const
                       load_balance_collect    (vector_fields,            output.particles,                         round_info);
                       out_of_bounds_distribute(               particles,                                           round_info);
   }
-  gather_particles     (output.particles      );
-  prune_integral_curves(output.integral_curves);
+  gather_particles(output.particles);
   return output;
 }
 
@@ -228,14 +244,14 @@ void                          particle_advector::load_balance_distribute (
         });
 
         requests.push_back(communicator->isend(neighbor.second.rank, 0, outgoing_particles));
-        std::cout << "Send " << outgoing_particles.size() << " particles to neighbor " << neighbor.first << "\n";
+        logger::instance().debug("Send ", outgoing_particles.size(), " particles to neighbor ", neighbor.first);
       } 
       for (auto& neighbor : neighbor_load_balancing_info)
       {
         std::vector<particle<vector3, integer>> incoming_particles;
         communicator->recv(neighbor.second.rank, 0, incoming_particles);
         particles.insert(particles.end(), incoming_particles.begin(), incoming_particles.end());
-        std::cout << "Recv " << incoming_particles.size() << " particles from neighbor " << neighbor.first << "\n";
+        logger::instance().debug("Recv ", incoming_particles.size(), " particles from neighbor ", neighbor.first);
       }   
       for (auto& request : requests)
         request.wait();
@@ -243,16 +259,46 @@ void                          particle_advector::load_balance_distribute (
 #endif
   }
 }
-particle_advector::round_info particle_advector::compute_round_info      (                                                                                      const std::vector<particle<vector3, integer>>& particles) 
+particle_advector::round_info particle_advector::compute_round_info      (                                                                                            std::vector<particle<vector3, integer>>& particles) 
 {
   round_info round_info;
   round_info.particle_count = std::min(std::size_t(particles_per_round_), particles.size());
 
-  if (record_)
+  // The round takes the particles at the back, in order. The particles are appended in order of arrival, hence the earliest arrivals
+  // are at the front and are rotated to the back, which keeps the others in order of arrival.
+  const auto round_begin      = particles.end() - round_info.particle_count;
+  const auto longest_first    = [ ] (const particle<vector3, integer>& lhs, const particle<vector3, integer>& rhs) { return lhs.remaining_iterations > rhs.remaining_iterations; };
+  if      (scheduling_ == scheduling::fifo                    || scheduling_ == scheduling::age_priority)
+    std::rotate(particles.begin(), particles.begin() + round_info.particle_count, particles.end());
+  else if (scheduling_ == scheduling::longest_remaining_first && round_info.particle_count < particles.size())
+    std::nth_element(particles.begin(), round_begin, particles.end(), [&] (const auto& lhs, const auto& rhs) { return longest_first(rhs, lhs); });
+  if      (scheduling_ == scheduling::longest_remaining_first || scheduling_ == scheduling::age_priority)
+    tbb::parallel_sort(round_begin, particles.end(), longest_first);
+
+  // The per-thread chunks (up to twice their size due to the growth of the vectors) and the compacted curves of the round hold each
+  // vertex up to three times. The round is trimmed from the end the policy de-prioritises, i.e. the head of the round (the latest
+  // arrivals at the back for lifo, the particles from round_begin otherwise) is taken as long as its maximum curves fit the budget,
+  // yet at least one particle.
+  if (record_ && round_memory_budget_ > 0)
   {
-    // Two more vertices per curve; one for initial position, one for termination vertex.
-    round_info.curve_stride = std::max_element(particles.end() - round_info.particle_count, particles.end(), [ ] (const particle<vector3, integer>& lhs, const particle<vector3, integer>& rhs) { return lhs.remaining_iterations < rhs.remaining_iterations; })->remaining_iterations + 2;
-    round_info.vertex_count = round_info.particle_count * round_info.curve_stride;
+    const auto  from_back = scheduling_ == scheduling::lifo;
+    std::size_t count     = 0;
+    std::size_t memory    = 0;
+    for (; count < round_info.particle_count; ++count)
+    {
+      const auto& particle = from_back ? particles[particles.size() - 1 - count] : round_begin[count];
+      memory += 3 * sizeof(vector3) * decimator_.maximum_vertices(std::size_t(particle.remaining_iterations)) + sizeof(std::size_t);
+      if (memory > round_memory_budget_ && count > 0)
+        break;
+    }
+    if (count < round_info.particle_count)
+    {
+      // The round remains at the back. The trimmed particles move to the front, where fifo and age_priority take them first again.
+      if (!from_back)
+        std::rotate(particles.begin(), round_begin + count, particles.end());
+      logger::instance().debug("Limited the round to ", count, " of ", round_info.particle_count, " particles by the memory budget");
+    }
+    round_info.particle_count = count;
   }
 
   for (auto& partition : partitioner_->partitions())
@@ -267,12 +313,33 @@ void                          particle_advector::allocate_integral_curves(
 {
   if (!record_) return;
 
-  integral_curves.emplace_back().resize(round_info.vertex_count, invalid_value<vector3>());
+  // Only the offsets are sized up front. The vertices are appended to per-thread chunks during advection and compacted afterwards.
+  integral_curves.emplace_back().offsets.resize(round_info.particle_count + 1, 0);
 }
 void                          particle_advector::advect                  (const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields,       std::vector<particle<vector3, integer>>& particles, std::vector<particle<vector3, integer>>& inactive_particles, integral_curves_3d& integral_curves,       round_info& round_info)
 {
-  tbb::mutex mutex;
-  tbb::parallel_for(std::size_t(0), round_info.particle_count, std::size_t(1), [&] (const std::size_t particle_index)
+  // The chunk and the first vertex index within it, per curve.
+  std::vector<std::pair<const std::vector<vector3>*, std::size_t>> curve_sources;
+  if (record_)
+  {
+    for (auto& chunk : vertex_chunks_)
+      chunk.clear();
+    curve_sources.resize(round_info.particle_count);
+  }
+
+  if (handoff_batch_size_ > 0)
+    handoff_receiver_ = std::thread(&particle_advector::receive_handoffs, this, round_info.out_of_bounds_particles.size());
+
+  tbb::mutex                                 mutex;
+  tbb::combinable<std::size_t>               particle_steps    ([ ] { return std::size_t(0); });
+  tbb::combinable<termination_criteria::counts> termination_counts([ ] { return termination_criteria::counts {}; });
+#ifdef DPA_COUNTER_SUPPORT
+  for (auto& vector_field : vector_fields)
+    page_map(vector_field.second);
+#endif
+  const auto bounds = bin_by_node(vector_fields, particles, round_info);
+
+  const auto advect_particle = [&] (const std::size_t particle_index)
   {
     auto& particle        = particles[particles.size() - round_info.particle_count + particle_index];
     auto& vector_field    = vector_fields.at(particle.relative_direction);
@@ -280,14 +347,59 @@ void                          particle_advector::advect                  (const
     auto  upper_bounds    = vector_field.offset + vector_field.size;
     auto  integrator      = integrator_;
     auto  iteration_index = 0;
+    auto& decimator       = decimators_.local();
+    auto  vertex_chunk    = record_ ? &vertex_chunks_.local() : nullptr;
+    auto  emit            = [&] (const vector3& vertex) { vertex_chunk->push_back(vertex); };
+    auto  anchor          = std::make_pair(particle.position, 0); // Position and iteration index at the start of the stagnation window.
+    DPA_COUNTER(auto& counters = counters_.local());
+    DPA_COUNTER(const auto& page_map = page_maps_.at(&vector_field));
+    DPA_COUNTER(const auto  node     = numa_domains::current_node());
+
+    const auto terminate  = [&] (const termination_criteria::reason reason)
+    {
+      ++termination_counts.local()[static_cast<std::size_t>(reason)];
+      DPA_COUNTER(const auto wait_start = advection_counters::clock::now());
+      tbb::mutex::scoped_lock lock(mutex);
+      DPA_COUNTER(counters.wait_time += advection_counters::milliseconds(wait_start));
+      inactive_particles.push_back(particle);
+    };
 
     if (record_)
-      integral_curves.back()[particle_index * round_info.curve_stride] = particle.position;
+    {
+      curve_sources[particle_index] = {vertex_chunk, vertex_chunk->size()};
+      decimator.begin(particle.position, emit);
+    }
 
     for ( ; particle.remaining_iterations > 0; ++iteration_index, --particle.remaining_iterations)
     {
+      if (termination_.maximum_time       && particle.time       >= *termination_.maximum_time      )
+      {
+        terminate(termination_criteria::reason::time);
+        break;
+      }
+      if (termination_.maximum_arc_length && particle.arc_length >= *termination_.maximum_arc_length)
+      {
+        terminate(termination_criteria::reason::arc_length);
+        break;
+      }
+      if (termination_.region             && !termination_.region->contains(particle.position)     )
+      {
+        terminate(termination_criteria::reason::region);
+        break;
+      }
+      if (termination_.stagnation_window  && iteration_index - anchor.second >= *termination_.stagnation_window)
+      {
+        if ((particle.position - anchor.first).norm() < termination_.stagnation_distance)
+        {
+          terminate(termination_criteria::reason::stagnation);
+          break;
+        }
+        anchor = std::make_pair(particle.position, iteration_index);
+      }
+
       if (!vector_field.contains(particle.position))
       {
+        DPA_COUNTER(++counters.contains_failures);
         if (particle.relative_direction == relative_direction::center) // if non-load balanced particle:
         {
           std::optional<relative_direction> direction;
@@ -298,33 +410,55 @@ void                          particle_advector::advect                  (const
           else if (particle.position[2] < lower_bounds[2]) direction = relative_direction::negative_z;
           else if (particle.position[2] > upper_bounds[2]) direction = relative_direction::positive_z;
 
+          DPA_COUNTER(const auto wait_start = advection_counters::clock::now());
           round_info::particle_map::accessor accessor;
           if (direction && round_info.out_of_bounds_particles.find(accessor, direction.value()))
+          {
+            DPA_COUNTER(counters.wait_time += advection_counters::milliseconds(wait_start));
+            DPA_COUNTER(++counters.handoffs[advection_counters::direction_index(direction.value())]);
             accessor->second.push_back(particle);
+            if (handoff_batch_size_ > 0 && accessor->second.size() >= std::size_t(handoff_batch_size_))
+            {
+              auto batch = std::move(accessor->second);
+              accessor->second.clear();
+              accessor.release();
+              send_handoff(direction.value(), std::move(batch));
+            }
+          }
           else
           {
-            tbb::mutex::scoped_lock lock(mutex);
-            inactive_particles.push_back(particle);
+            DPA_COUNTER(counters.wait_time += advection_counters::milliseconds(wait_start));
+            terminate(termination_criteria::reason::domain);
           }
         }
         else // if load balanced particle:
         {
+          DPA_COUNTER(const auto wait_start = advection_counters::clock::now());
           round_info::particle_map::accessor accessor;
           if (round_info.load_balanced_out_of_bounds_particles.find(accessor, particle.relative_direction))
+          {
+            DPA_COUNTER(counters.wait_time += advection_counters::milliseconds(wait_start));
+            DPA_COUNTER(++counters.load_balanced_handoffs);
             accessor->second.push_back(particle);
+          }
         }
         break;
       }
 
       const auto vector = vector_field.interpolate(particle.position);
-      if (vector.isZero())
+      DPA_COUNTER(++counters.interpolations);
+      DPA_COUNTER(const ivector3 cell = ((particle.position - vector_field.offset).array() / vector_field.spacing.array()).cast<integer>());
+      DPA_COUNTER(const auto cell_node = page_map.node(&vector_field.data[cell[0]][cell[1]][cell[2]]));
+      DPA_COUNTER(counters.remote_interpolations += cell_node >= 0 && node >= 0 && cell_node != node);
+      if (vector.isZero() || (termination_.minimum_speed && vector.norm() < *termination_.minimum_speed))
       {
-        tbb::mutex::scoped_lock lock(mutex);
-        inactive_particles.push_back(particle);
-
+        DPA_COUNTER(++counters.zero_vector_terminations);
+        terminate(termination_criteria::reason::velocity);
         break;
       }
 
+      const auto previous_position = particle.position;
+
       const auto system = [&] (const vector3& x, vector3& dxdt, const float t) { dxdt = vector; };
       if      (std::holds_alternative<euler_integrator<vector3>>                       (integrator))
         std::get<euler_integrator<vector3>>                       (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
@@ -342,21 +476,76 @@ void                          particle_advector::advect                  (const
         std::get<adams_bashforth_2_integrator<vector3>>           (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
       else if (std::holds_alternative<adams_bashforth_moulton_2_integrator<vector3>>   (integrator))
         std::get<adams_bashforth_moulton_2_integrator<vector3>>   (integrator).do_step(system, particle.position, iteration_index * step_size_, step_size_);
-      
+      DPA_COUNTER(++counters.integration_steps);
+
+      particle.time += step_size_;
+      if (termination_.maximum_arc_length)
+        particle.arc_length += (particle.position - previous_position).norm();
+
       if (record_)
-        integral_curves.back()[particle_index * round_info.curve_stride + iteration_index + 1] = particle.position;
+        decimator.push(particle.position, emit);
     }
 
+    particle_steps.local() += iteration_index;
+
     if (record_)
-      integral_curves.back()[particle_index * round_info.curve_stride + iteration_index + 1] = terminal_value<vector3>();
+    {
+      decimator.end(emit);
+      integral_curves.back().offsets[particle_index + 1] = vertex_chunk->size() - curve_sources[particle_index].second;
+    }
 
     if (particle.remaining_iterations == 0)
+      terminate(termination_criteria::reason::iterations);
+  };
+  if (scheduling_ == scheduling::longest_remaining_first || scheduling_ == scheduling::age_priority)
+  {
+    // Ordered dispatch: Each task claims the next particle of the round until none are left, hence the particles start in order
+    // (unlike the range splitting of parallel_for) and the longest ones do not trail at the end of the round.
+    // The tasks of each arena claim from the range of the arena.
+    const auto                            slots = numa_domains::instance().slot_bounds();
+    std::vector<std::atomic<std::size_t>> next (bounds.size() - 1);
+    for (std::size_t arena = 0; arena < next.size(); ++arena)
+      next[arena] = bounds[arena];
+    numa_domains::instance().parallel_for(slots, [&] (const std::size_t slot)
     {
-      tbb::mutex::scoped_lock lock(mutex);
-      inactive_particles.push_back(particle);
-    }
-  });
+      const auto arena = std::size_t(std::upper_bound(slots.begin(), slots.end(), slot) - slots.begin()) - 1;
+      for (auto particle_index = next[arena]++; particle_index < bounds[arena + 1]; particle_index = next[arena]++)
+        advect_particle(particle_index);
+    });
+  }
+  else
+    numa_domains::instance().parallel_for(bounds, advect_particle);
   particles.resize(particles.size() - round_info.particle_count);
+  round_info.particle_steps = particle_steps.combine(std::plus<std::size_t>());
+  termination_counts.combine_each([&] (const termination_criteria::counts& counts)
+  {
+    for (std::size_t index = 0; index < counts.size(); ++index)
+      termination_counts_[index] += counts[index];
+  });
+
+#ifdef DPA_COUNTER_SUPPORT
+  round_counters_.push_back(counters_.combine([ ] (advection_counters lhs, const advection_counters& rhs) { return lhs += rhs; }));
+  for (auto& counters : counters_)
+    counters = advection_counters();
+#endif
+
+  if (record_)
+  {
+    // Compact the per-thread chunks into the round's integral curves. The offsets hold the curve sizes until the scan.
+    auto& curves = integral_curves.back();
+    std::partial_sum(curves.offsets.begin(), curves.offsets.end(), curves.offsets.begin());
+    curves.vertices.resize(curves.offsets.back());
+    tbb::parallel_for(std::size_t(0), round_info.particle_count, std::size_t(1), [&] (const std::size_t particle_index)
+    {
+      const auto& source = curve_sources[particle_index];
+      std::copy_n(source.first->begin() + source.second, curves.curve_size(particle_index), curves.vertices.begin() + curves.offsets[particle_index]);
+    });
+
+    // Under a memory budget, the capacity of the chunks is not retained beyond the round.
+    if (round_memory_budget_ > 0)
+      for (auto& chunk : vertex_chunks_)
+        std::vector<vector3>().swap(chunk);
+  }
 }
 void                          particle_advector::load_balance_collect    (const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields,                                                           std::vector<particle<vector3, integer>>& inactive_particles,                                            round_info& round_info) 
 {
@@ -405,6 +594,7 @@ void                          particle_advector::load_balance_collect    (const
         {
           tbb::mutex::scoped_lock lock(mutex);
           inactive_particles.push_back(particle);
+          ++termination_counts_[static_cast<std::size_t>(termination_criteria::reason::domain)];
         }
       });
     }
@@ -416,6 +606,27 @@ void                          particle_advector::load_balance_collect    (const
 }                                                                                                                                                                                                                         
 void                          particle_advector::out_of_bounds_distribute(                                                                                            std::vector<particle<vector3, integer>>& particles,                                                                                                   const round_info& round_info) 
 {
+  if (handoff_batch_size_ > 0)
+  {
+    // The remaining partial batches (including those of load_balance_collect), followed by the end markers.
+    for (auto& neighbor : round_info.out_of_bounds_particles)
+    {
+      if (!neighbor.second.empty())
+        send_handoff(neighbor.first, std::vector<particle<vector3, integer>>(neighbor.second));
+      send_handoff(neighbor.first, {});
+    }
+    handoff_receiver_.join();
+
+    for (auto& handoff : handoff_sends_)
+      MPI_Wait(&handoff.request, MPI_STATUS_IGNORE);
+    handoff_sends_.clear();
+
+    std::vector<particle<vector3, integer>> batch;
+    while (inbound_particles_.try_pop(batch))
+      particles.insert(particles.end(), batch.begin(), batch.end());
+    return;
+  }
+
 #ifdef DPA_USE_NEIGHBORHOOD_COLLECTIVES
   // TODO: Neighborhood collectives.
 #else
@@ -442,33 +653,141 @@ void                          particle_advector::gather_particles        (
   if (!gather_particles_) return;
 
 #ifdef DPA_FTLE_SUPPORT
-  std::vector<std::vector<particle<vector3, integer>>> sent    (partitioner_->cartesian_communicator()->size());
-  std::vector<std::vector<particle<vector3, integer>>> received(partitioner_->cartesian_communicator()->size());
+  auto       communicator = partitioner_->cartesian_communicator();
+  const auto size         = std::size_t(communicator->size());
 
-  tbb::mutex mutex;
-  tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&](const std::size_t index)
+  // Counting sort by original rank. Each chunk counts its particles per rank, and the exclusive prefix sum over [rank][chunk] yields
+  // disjoint write offsets per chunk and rank, hence the chunks are scattered in parallel without synchronization.
+  const auto chunk_count = std::max(std::size_t(1), std::min(particles.size(), std::size_t(4 * tbb::this_task_arena::max_concurrency())));
+  const auto chunk_size  = (particles.size() + chunk_count - 1) / chunk_count;
+  const auto chunk_range = [&] (const std::size_t chunk) { return std::make_pair(std::min(chunk * chunk_size, particles.size()), std::min((chunk + 1) * chunk_size, particles.size())); };
+
+  std::vector<std::size_t> offsets(size * chunk_count, 0);
+  tbb::parallel_for(std::size_t(0), chunk_count, std::size_t(1), [&] (const std::size_t chunk)
   {
-    tbb::mutex::scoped_lock lock(mutex);
-    sent[particles[index].original_rank].push_back(particles[index]);
+    const auto range = chunk_range(chunk);
+    for (auto index = range.first; index < range.second; ++index)
+      ++offsets[particles[index].original_rank * chunk_count + chunk];
   });
+  std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), std::size_t(0));
 
-  boost::mpi::all_to_all(*partitioner_->cartesian_communicator(), sent, received);
+  std::vector<particle<vector3, integer>> sorted(particles.size());
+  tbb::parallel_for(std::size_t(0), chunk_count, std::size_t(1), [&] (const std::size_t chunk)
+  {
+    const auto range = chunk_range(chunk);
+    for (auto index = range.first; index < range.second; ++index)
+      sorted[offsets[particles[index].original_rank * chunk_count + chunk]++] = particles[index];
+  });
 
-  particles.clear();
-  for (auto& particles_vector : received)
-    particles.insert(particles.end(), particles_vector.begin(), particles_vector.end());
+  // After the scatter, the offset of the first chunk of a rank is the end of the previous rank.
+  std::vector<int> send_counts(size, 0), send_displacements(size, 0), receive_counts(size, 0), receive_displacements(size, 0);
+  for (std::size_t rank = 1; rank < size; ++rank)
+    send_displacements[rank] = int(offsets[rank * chunk_count - 1]);
+  for (std::size_t rank = 0; rank < size; ++rank)
+    send_counts[rank] = int((rank + 1 < size ? std::size_t(send_displacements[rank + 1]) : particles.size()) - send_displacements[rank]);
+
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, *communicator);
+  for (std::size_t rank = 1; rank < size; ++rank)
+    receive_displacements[rank] = receive_displacements[rank - 1] + receive_counts[rank - 1];
+
+  // Particles are plain data, hence sent as contiguous bytes instead of being serialized.
+  MPI_Datatype particle_type;
+  MPI_Type_contiguous(int(sizeof(particle<vector3, integer>)), MPI_BYTE, &particle_type);
+  MPI_Type_commit    (&particle_type);
+
+  particles.resize(std::size_t(receive_displacements.back() + receive_counts.back()));
+  MPI_Alltoallv(sorted   .data(), send_counts   .data(), send_displacements   .data(), particle_type,
+                particles.data(), receive_counts.data(), receive_displacements.data(), particle_type, *communicator);
+
+  MPI_Type_free(&particle_type);
 #else
-  std::cout << "Particles are not gathered since original ranks are unavailable. Declare DPA_FTLE_SUPPORT and rebuild." << std::endl;
+  logger::instance().warning("Particles are not gathered since original ranks are unavailable. Declare DPA_FTLE_SUPPORT and rebuild.");
 #endif
 }
-void                          particle_advector::prune_integral_curves   (                                                                                                                                                                                                                   integral_curves_3d& integral_curves) 
+
+void                          particle_advector::send_handoff            (const relative_direction direction, std::vector<particle<vector3, integer>>&& particles)
 {
-  if (!record_) return;
-  
-  tbb::parallel_for(std::size_t(0), integral_curves.size(), std::size_t(1), [&](const std::size_t index)
+  // The elements of a concurrent_vector are not relocated, hence the buffer remains valid until the request completes.
+  auto& send = *handoff_sends_.emplace_back(handoff {std::move(particles)});
+  MPI_Isend(send.particles.data(), int(send.particles.size() * sizeof(particle<vector3, integer>)), MPI_BYTE, partitioner_->partitions().at(direction).rank, handoff_tag, *partitioner_->cartesian_communicator(), &send.request);
+}
+void                          particle_advector::receive_handoffs        (std::size_t end_markers)
+{
+  auto communicator = partitioner_->cartesian_communicator();
+  while (end_markers > 0)
   {
-    auto& curves = integral_curves[index];
-    curves.erase(std::remove(curves.begin(), curves.end(), invalid_value<vector3>()), curves.end());
+    int         available = 0;
+    MPI_Message message;
+    MPI_Status  status;
+    MPI_Improbe(MPI_ANY_SOURCE, handoff_tag, *communicator, &available, &message, &status);
+    if (!available)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    int size = 0;
+    MPI_Get_count(&status, MPI_BYTE, &size);
+    std::vector<particle<vector3, integer>> particles(std::size_t(size) / sizeof(particle<vector3, integer>));
+    MPI_Mrecv(particles.data(), size, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+
+    if (particles.empty())
+      --end_markers;
+    else
+    {
+      logger::instance().debug("Recv ", particles.size(), " streamed particles from rank ", status.MPI_SOURCE);
+      inbound_particles_.push(std::move(particles));
+    }
+  }
+}
+std::vector<std::size_t>      particle_advector::bin_by_node             (const std::unordered_map<relative_direction, regular_vector_field_3d>& vector_fields,       std::vector<particle<vector3, integer>>& particles, const round_info& round_info)
+{
+  auto&      domains     = numa_domains::instance();
+  const auto count       = round_info.particle_count;
+  const auto arena_count = domains.arena_count();
+  if (arena_count == 0 || count == 0)
+    return domains.bounds(count);
+
+  for (auto& vector_field : vector_fields)
+    page_map(vector_field.second);
+
+  // The particles in cells on pages of no arena's node (e.g. not yet touched) are assigned in proportion to the arenas instead.
+  const auto               round_begin  = particles.end() - count;
+  const auto               proportional = domains.bounds(count);
+  std::vector<std::size_t> arenas(count);
+  tbb::parallel_for(std::size_t(0), count, std::size_t(1), [&] (const std::size_t index)
+  {
+    const auto&    particle     = round_begin[index];
+    const auto&    vector_field = vector_fields.at(particle.relative_direction);
+    const auto     shape        = vector_field.data.shape();
+    const ivector3 cell         = ((particle.position - vector_field.offset).array() / vector_field.spacing.array()).cast<integer>()
+      .max(0).min(ivector3(integer(shape[0]), integer(shape[1]), integer(shape[2])).array() - 1);
+
+    auto arena = domains.arena(page_maps_.at(&vector_field).node(&vector_field.data[cell[0]][cell[1]][cell[2]]));
+    if (arena == arena_count)
+      arena = std::size_t(std::upper_bound(proportional.begin(), proportional.end(), index) - proportional.begin()) - 1;
+    arenas[index] = arena;
   });
+
+  // A stable counting sort, which retains the order of the scheduling policy within each arena.
+  std::vector<std::size_t> bounds(arena_count + 1, 0);
+  for (const auto arena : arenas)
+    ++bounds[arena + 1];
+  std::partial_sum(bounds.begin(), bounds.end(), bounds.begin());
+
+  auto                                    offsets = bounds;
+  std::vector<particle<vector3, integer>> sorted (count);
+  for (std::size_t index = 0; index < count; ++index)
+    sorted[offsets[arenas[index]]++] = round_begin[index];
+  std::copy(sorted.begin(), sorted.end(), round_begin);
+
+  return bounds;
+}
+const numa_domains::page_map& particle_advector::page_map                (const regular_vector_field_3d& vector_field)
+{
+  auto iterator = page_maps_.find(&vector_field);
+  if (iterator == page_maps_.end())
+    iterator = page_maps_.emplace(&vector_field, numa_domains::map_pages(vector_field.data.data(), vector_field.data.num_elements() * sizeof(vector3))).first;
+  return iterator->second;
 }
 }
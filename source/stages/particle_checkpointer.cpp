@@ -0,0 +1,148 @@
+#include <dpa/stages/particle_checkpointer.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <utility>
+
+#include <boost/mpi.hpp>
+
+#include <dpa/utility/logger.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+particle_checkpointer::particle_checkpointer (domain_partitioner* partitioner, const std::string& filepath, const integer round_interval, const scalar time_interval)
+: partitioner_   (partitioner)
+, filepath_      (std::filesystem::path(filepath).replace_extension(".rank_" + std::to_string(partitioner_->cartesian_communicator()->rank()) + ".checkpoint").string())
+, round_interval_(round_interval)
+, time_interval_ (time_interval)
+, last_time_     (std::chrono::steady_clock::now())
+{
+
+}
+particle_checkpointer::~particle_checkpointer()
+{
+  wait();
+}
+
+bool                                        particle_checkpointer::due          (const integer round)
+{
+  auto due = round_interval_ > 0 && round > 0 && round % round_interval_ == 0;
+  if (time_interval_ > scalar(0))
+  {
+    auto elapsed = std::chrono::duration<scalar>(std::chrono::steady_clock::now() - last_time_).count() >= time_interval_;
+    boost::mpi::broadcast(*partitioner_->cartesian_communicator(), elapsed, 0);
+    due = due || elapsed;
+  }
+  return due;
+}
+void                                        particle_checkpointer::save         (const integer round, const std::vector<particle<vector3, integer>>& active_particles, const std::vector<particle<vector3, integer>>& inactive_particles)
+{
+  // Starting the next checkpoint only once the previous one is complete on all ranks guarantees that the other slot holds a
+  // checkpoint which is complete everywhere, whichever rank fails during the write.
+  wait();
+  partitioner_->cartesian_communicator()->barrier();
+  last_time_ = std::chrono::steady_clock::now();
+
+  header header {};
+  header.magic          = magic;
+  header.particle_size  = sizeof(particle<vector3, integer>);
+  header.rank           = partitioner_->cartesian_communicator()->rank();
+  header.size           = partitioner_->cartesian_communicator()->size();
+  header.round          = round;
+  header.active_count   = active_particles  .size();
+  header.inactive_count = inactive_particles.size();
+
+  pending_ = std::async(std::launch::async, [filepath = slot_filepath(next_slot_), header, active_particles, inactive_particles] ()
+  {
+    std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(&header)                  , sizeof header);
+    stream.write(reinterpret_cast<const char*>(active_particles  .data()), active_particles  .size() * sizeof(particle<vector3, integer>));
+    stream.write(reinterpret_cast<const char*>(inactive_particles.data()), inactive_particles.size() * sizeof(particle<vector3, integer>));
+    stream.write(reinterpret_cast<const char*>(&footer)                  , sizeof footer);
+    if (!stream)
+      logger::instance().error("Failed to write checkpoint ", filepath);
+  });
+  next_slot_ = 1 - next_slot_;
+}
+std::optional<particle_checkpointer::state> particle_checkpointer::load         ()
+{
+  auto communicator = partitioner_->cartesian_communicator();
+
+  std::optional<state> slots[] = {read(0), read(1)};
+  const auto           newest   = std::size_t(slots[1] && (!slots[0] || slots[1]->round > slots[0]->round) ? 1 : 0);
+
+  // The newest round complete on all ranks is the minimum of the newest rounds. Otherwise (e.g. all but the oldest checkpoint of a rank are incomplete), the minimum of the oldest.
+  for (auto candidate : {newest, 1 - newest})
+  {
+    const auto local_round = slots[candidate] ? slots[candidate]->round : integer(-1);
+    const auto round       = boost::mpi::all_reduce(*communicator, local_round, boost::mpi::minimum<integer>());
+    if (round < 0)
+      break;
+
+    const auto matches     = [&] (const std::size_t slot) { return slots[slot] && slots[slot]->round == round; };
+    const auto match       = std::size_t(matches(0) ? 0 : 1);
+    if (boost::mpi::all_reduce(*communicator, matches(match), std::logical_and<bool>()))
+    {
+      next_slot_ = 1 - match; // Keeps the restored checkpoint intact until the next one is complete.
+      return std::move(slots[match]);
+    }
+  }
+  return std::nullopt;
+}
+
+void                                        particle_checkpointer::remove       ()
+{
+  // Removing only once all ranks completed keeps a restartable checkpoint should any rank fail before.
+  wait();
+  partitioner_->cartesian_communicator()->barrier();
+
+  std::error_code error;
+  for (const std::size_t slot : {0, 1})
+    std::filesystem::remove(slot_filepath(slot), error);
+}
+
+std::string                                 particle_checkpointer::slot_filepath(const std::size_t slot) const
+{
+  return filepath_ + "_" + std::to_string(slot);
+}
+std::optional<particle_checkpointer::state> particle_checkpointer::read         (const std::size_t slot) const
+{
+  std::ifstream stream(slot_filepath(slot), std::ios::binary);
+  if (!stream)
+    return std::nullopt;
+
+  header header {};
+  stream.read(reinterpret_cast<char*>(&header), sizeof header);
+  if (!stream                                                                        ||
+      header.magic         != magic                                                  ||
+      header.particle_size != sizeof(particle<vector3, integer>)                     ||
+      header.rank          != partitioner_->cartesian_communicator()->rank()         ||
+      header.size          != partitioner_->cartesian_communicator()->size())
+    return std::nullopt;
+
+  state state;
+  state.round = header.round;
+  state.active_particles  .resize(header.active_count  );
+  state.inactive_particles.resize(header.inactive_count);
+  stream.read(reinterpret_cast<char*>(state.active_particles  .data()), header.active_count   * sizeof(particle<vector3, integer>));
+  stream.read(reinterpret_cast<char*>(state.inactive_particles.data()), header.inactive_count * sizeof(particle<vector3, integer>));
+
+  std::uint64_t end = 0;
+  stream.read(reinterpret_cast<char*>(&end), sizeof end);
+  if (!stream || end != footer)
+    return std::nullopt;
+
+  return state;
+}
+void                                        particle_checkpointer::wait         ()
+{
+  if (pending_.valid())
+    pending_.wait();
+}
+}
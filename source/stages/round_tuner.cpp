@@ -0,0 +1,121 @@
+#include <dpa/stages/round_tuner.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include <mpi.h>
+
+#include <dpa/utility/logger.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+std::string                                 round_tuner::decision::csv_header()
+{
+  return "round,particle count,advection time,communication time,particle time,particle memory,headroom,time quota,memory quota,quota,limit";
+}
+std::string                                 round_tuner::decision::to_string () const
+{
+  std::ostringstream stream;
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  stream << round << "," << particle_count << "," << advection_time << "," << communication_time << "," << particle_time << "," << particle_memory << ","
+         << headroom << "," << time_quota << "," << memory_quota << "," << quota << "," << limit;
+  return stream.str();
+}
+
+round_tuner::round_tuner (domain_partitioner* partitioner, const integer particles_per_round, const scalar target_round_time, const std::optional<scalar>& memory_budget)
+: partitioner_      (partitioner)
+, quota_            (std::max(particles_per_round, 1))
+, minimum_quota_    (std::max(integer(double(quota_) / shrinkage), 1))
+, target_round_time_(double(target_round_time) * 1000.0)
+, memory_budget_    (memory_budget ? std::optional<double>(double(*memory_budget) * 1024.0 * 1024.0) : std::nullopt)
+{
+
+}
+
+integer                                     round_tuner::update   (const measurement& measurement)
+{
+  const auto count     = double(measurement.particle_count);
+  const auto headroom  = memory_budget_ ? *memory_budget_ - double(measurement.memory) : std::numeric_limits<double>::infinity();
+
+  // The maxima, with the headroom negated to reduce its minimum along.
+  std::array<double, 6> values
+  {
+    count,
+    measurement.advection_time,
+    measurement.communication_time,
+    count > 0.0 ? measurement.advection_time      / count : 0.0,
+    count > 0.0 ? double(measurement.round_memory) / count : 0.0,
+    -headroom
+  };
+  MPI_Allreduce(MPI_IN_PLACE, values.data(), int(values.size()), MPI_DOUBLE, MPI_MAX, *partitioner_->cartesian_communicator());
+
+  decision decision;
+  decision.round              = integer(decisions_.size());
+  decision.particle_count     = std::size_t(values[0]);
+  decision.advection_time     = values[1];
+  decision.communication_time = values[2];
+  decision.particle_time      = values[3];
+  decision.particle_memory    = values[4];
+  decision.headroom           = -values[5];
+
+  const auto maximum  = double(std::numeric_limits<integer>::max());
+  const auto to_quota = [&] (const double value) { return integer(std::clamp(std::floor(value), double(minimum_quota_), maximum)); };
+
+  // A round without particles or time carries no information.
+  auto target = double(quota_);
+  decision.limit = "none";
+  if (decision.particle_time > 0.0)
+  {
+    const auto available = target_round_time_ - decision.communication_time;
+    if (available > 0.0)
+    {
+      target         = available / decision.particle_time;
+      decision.limit = "time";
+    }
+    else
+      decision.limit = "communication";
+  }
+  decision.time_quota = to_quota(target);
+
+  auto next = double(quota_) + gain * (target - double(quota_));
+  if (next > double(quota_) * growth || next < double(quota_) / growth)
+  {
+    next           = std::clamp(next, double(quota_) / growth, double(quota_) * growth);
+    decision.limit = "step";
+  }
+
+  decision.memory_quota = std::numeric_limits<integer>::max();
+  if (memory_budget_ && decision.particle_memory > 0.0)
+  {
+    decision.memory_quota = to_quota(std::max(decision.headroom, 0.0) / decision.particle_memory);
+    if (decision.headroom <= 0.0 && !std::exchange(exhausted_, true) && partitioner_->cartesian_communicator()->rank() == 0)
+      logger::instance().warning("The memory budget of the round tuner is exhausted after round ", decision.round, ". Continuing with ", decision.memory_quota, " particles per round.");
+    if (double(decision.memory_quota) < next)
+    {
+      next           = double(decision.memory_quota);
+      decision.limit = "memory";
+    }
+  }
+
+  quota_         = to_quota(next);
+  decision.quota = quota_;
+  decisions_.push_back(decision);
+  return quota_;
+}
+
+integer                                     round_tuner::quota    () const
+{
+  return quota_;
+}
+const std::vector<round_tuner::decision>&   round_tuner::decisions() const
+{
+  return decisions_;
+}
+}
@@ -0,0 +1,145 @@
+#include <dpa/stages/seed_file_loader.hpp>
+
+#include <array>
+
+#include <hdf5.h>
+#include <mpi.h>
+#include <tbb/tbb.h>
+
+#include <dpa/math/indexing.hpp>
+
+#undef min
+#undef max
+
+namespace dpa
+{
+seed_file_loader::seed_file_loader (domain_partitioner* partitioner, const std::string& filepath, const std::optional<std::string>& dataset_path)
+: partitioner_(partitioner), filepath_(filepath), dataset_path_(dataset_path)
+{
+
+}
+
+std::vector<particle<vector3, integer>> seed_file_loader::load     (const vector3& spacing, integer iterations, std::optional<aabb3> aabb)
+{
+  const auto positions     = exchange(dataset_path_ ? read_hdf5() : read_raw(), spacing, aabb);
+  const auto process_index = partitioner_->cartesian_communicator()->rank();
+
+  std::vector<particle<vector3, integer>> particles(positions.size());
+  tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
+  {
+    particles[index] = particle<vector3, integer>(positions[index], iterations, process_index);
+  });
+  return particles;
+}
+
+std::pair<std::size_t, std::size_t>     seed_file_loader::slice    (const std::size_t count) const
+{
+  const auto rank = std::size_t(partitioner_->cartesian_communicator()->rank());
+  const auto size = std::size_t(partitioner_->cartesian_communicator()->size());
+  return {count * rank / size, count * (rank + 1) / size};
+}
+std::vector<vector3>                    seed_file_loader::read_hdf5() const
+{
+  const auto property = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_mpio(property, *partitioner_->communicator(), MPI_INFO_NULL);
+  const auto file     = H5Fopen  (filepath_.c_str(), H5F_ACC_RDONLY, property);
+  const auto dataset  = H5Dopen2 (file, dataset_path_->c_str(), H5P_DEFAULT);
+  H5Pclose(property);
+
+  std::array<hsize_t, 2> dimensions {0, 0};
+  const auto space    = H5Dget_space(dataset);
+  H5Sget_simple_extent_dims(space, dimensions.data(), nullptr);
+
+  const auto range    = slice(dimensions[0]);
+  std::vector<vector3> positions(range.second - range.first);
+
+  const std::array<hsize_t, 2> native_offset {hsize_t(range.first), 0};
+  const std::array<hsize_t, 2> native_size   {hsize_t(positions.size()), 3};
+
+  const auto memspace = H5Screate_simple(2, native_size.data(), nullptr);
+  const auto transfer = H5Pcreate       (H5P_DATASET_XFER);
+  H5Pset_dxpl_mpio   (transfer, H5FD_MPIO_COLLECTIVE);
+  H5Sselect_hyperslab(space, H5S_SELECT_SET, native_offset.data(), nullptr, native_size.data(), nullptr);
+  H5Dread            (dataset, H5T_NATIVE_FLOAT, memspace, space, transfer, positions.data());
+  H5Pclose           (transfer);
+  H5Sclose           (memspace);
+  H5Sclose           (space);
+  H5Dclose           (dataset);
+  H5Fclose           (file);
+
+  return positions;
+}
+std::vector<vector3>                    seed_file_loader::read_raw () const
+{
+  MPI_File file;
+  MPI_File_open(*partitioner_->communicator(), filepath_.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &file);
+
+  MPI_Offset file_size;
+  MPI_File_get_size(file, &file_size);
+
+  const auto range = slice(std::size_t(file_size) / sizeof(vector3));
+  std::vector<vector3> positions(range.second - range.first);
+  MPI_File_read_at_all(file, MPI_Offset(range.first * sizeof(vector3)), positions.data(), int(positions.size() * 3), MPI_FLOAT, MPI_STATUS_IGNORE);
+  MPI_File_close(&file);
+
+  return positions;
+}
+std::vector<vector3>                    seed_file_loader::exchange (const std::vector<vector3>& positions, const vector3& spacing, const std::optional<aabb3>& aabb) const
+{
+  auto       communicator = partitioner_->cartesian_communicator();
+  const auto grid_size    = partitioner_->grid_size();
+  const auto block_extent = vector3(spacing.array() * partitioner_->block_size ().cast<scalar>().array());
+  const auto domain       = aabb3  (vector3::Zero(), spacing.array() * partitioner_->domain_size().cast<scalar>().array());
+
+  // Ranks per block, looked up by the threads below instead of calling into MPI.
+  std::vector<integer> block_ranks(grid_size.prod());
+  for (std::size_t index = 0; index < block_ranks.size(); ++index)
+  {
+    const auto multi_index = unravel_index(index, grid_size);
+    block_ranks[index] = communicator->rank(std::vector<int> {multi_index[0], multi_index[1], multi_index[2]});
+  }
+
+  // Destination rank per seed (-1 if discarded), followed by a counting sort by destination.
+  std::vector<integer> destinations(positions.size());
+  tbb::parallel_for(std::size_t(0), positions.size(), std::size_t(1), [&] (const std::size_t index)
+  {
+    const auto& position = positions[index];
+    if (!domain.contains(position) || (aabb && !aabb->contains(position)))
+    {
+      destinations[index] = -1;
+      return;
+    }
+    const ivector3 multi_index = (position.array() / block_extent.array()).cast<integer>().min(grid_size.array() - 1).max(0);
+    destinations[index] = block_ranks[ravel_multi_index(multi_index, grid_size)];
+  });
+
+  const auto size = communicator->size();
+  std::vector<int> send_counts(size, 0), send_displacements(size, 0), receive_counts(size, 0), receive_displacements(size, 0);
+  for (const auto destination : destinations)
+    if (destination >= 0)
+      ++send_counts[destination];
+  for (auto rank = 1; rank < size; ++rank)
+    send_displacements[rank] = send_displacements[rank - 1] + send_counts[rank - 1];
+
+  std::vector<vector3> sorted(send_displacements.back() + send_counts.back());
+  auto                 cursors = send_displacements;
+  for (std::size_t index = 0; index < positions.size(); ++index)
+    if (destinations[index] >= 0)
+      sorted[cursors[destinations[index]]++] = positions[index];
+
+  MPI_Alltoall(send_counts.data(), 1, MPI_INT, receive_counts.data(), 1, MPI_INT, *communicator);
+  for (auto rank = 1; rank < size; ++rank)
+    receive_displacements[rank] = receive_displacements[rank - 1] + receive_counts[rank - 1];
+
+  MPI_Datatype vector_type;
+  MPI_Type_contiguous(3, MPI_FLOAT, &vector_type);
+  MPI_Type_commit    (&vector_type);
+
+  std::vector<vector3> received(receive_displacements.back() + receive_counts.back());
+  MPI_Alltoallv(sorted  .data(), send_counts   .data(), send_displacements   .data(), vector_type, 
+                received.data(), receive_counts.data(), receive_displacements.data(), vector_type, *communicator);
+
+  MPI_Type_free(&vector_type);
+  return received;
+}
+}
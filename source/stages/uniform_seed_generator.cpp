@@ -1,18 +1,18 @@
 #include <dpa/stages/uniform_seed_generator.hpp>
 
-#include <random>
+#include <tuple>
 
 #include <tbb/tbb.h>
 
 #include <dpa/math/indexing.hpp>
-#include <dpa/math/distributions/multivariate_uniform_distribution.hpp>
+#include <dpa/math/philox.hpp>
 
 #undef min
 #undef max
 
 namespace dpa
 {
-std::vector<particle<vector3, integer>> uniform_seed_generator::generate       (vector3 offset, vector3 size, vector3  stride, integer iterations, integer process_index, std::optional<aabb3> aabb)
+std::pair<vector3, ivector3>            uniform_seed_generator::grid           (vector3 offset, vector3 size, vector3  stride,                                         std::optional<aabb3> aabb)
 {
   if (aabb)
   {
@@ -24,7 +24,12 @@ std::vector<particle<vector3, integer>> uniform_seed_generator::generate       (
     }
   }
 
-  ivector3 particles_per_dimension = (size.array() / stride.array()).cast<integer>();
+  return {offset, (size.array() / stride.array()).cast<integer>()};
+}
+std::vector<particle<vector3, integer>> uniform_seed_generator::generate       (vector3 offset, vector3 size, vector3  stride, integer iterations, integer process_index, std::optional<aabb3> aabb)
+{
+  ivector3 particles_per_dimension;
+  std::tie(offset, particles_per_dimension) = grid(offset, size, stride, aabb);
 
   std::vector<particle<vector3, integer>> particles(particles_per_dimension.prod());
   tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
@@ -32,15 +37,11 @@ std::vector<particle<vector3, integer>> uniform_seed_generator::generate       (
     const ivector3 multi_index = unravel_index(index, particles_per_dimension);
     const vector3  position    = offset.array() + stride.array() * multi_index.cast<scalar>().array();
 
-#ifdef DPA_FTLE_SUPPORT
-    particles[index]           = {position, iterations, relative_direction::center, process_index};
-#else
-    particles[index]           = {position, iterations, relative_direction::center};
-#endif
+    particles[index]           = particle<vector3, integer>(position, iterations, process_index);
   });
   return particles;
 }
-std::vector<particle<vector3, integer>> uniform_seed_generator::generate_random(vector3 offset, vector3 size, integer  count , integer iterations, integer process_index, std::optional<aabb3> aabb)
+std::vector<particle<vector3, integer>> uniform_seed_generator::generate_random(vector3 offset, vector3 size, integer  count , integer iterations, integer process_index, std::optional<aabb3> aabb, std::uint32_t seed)
 {
   if (aabb)
   {
@@ -52,33 +53,26 @@ std::vector<particle<vector3, integer>> uniform_seed_generator::generate_random(
     }
   }
 
-  auto distribution_range = std::initializer_list
-  {
-    std::initializer_list {offset[0], offset[0] + size[0]},
-    std::initializer_list {offset[1], offset[1] + size[1]},
-    std::initializer_list {offset[2], offset[2] + size[2]}
-  };
+  // Keyed by the seed and process index, counted by the particle index. The seeds are therefore identical for any thread count.
+  const philox::key_type key {seed, std::uint32_t(process_index)};
 
   std::vector<particle<vector3, integer>> particles(count);
-  tbb::parallel_for(std::size_t(0), particles.size(), std::size_t(1), [&] (const std::size_t index)
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, particles.size()), [&] (const tbb::blocked_range<std::size_t>& range)
   {
-    static thread_local std::random_device     random_device   ;
-    static thread_local std::mt19937           mersenne_twister;
-    multivariate_uniform_distribution<vector3> distribution(distribution_range);
+    for (auto index = range.begin(); index != range.end(); ++index)
+    {
+      const auto    random   = philox::generate({std::uint32_t(index), std::uint32_t(std::uint64_t(index) >> 32), 0, 0}, key);
+      const vector3 position = offset.array() + size.array() * vector3(philox::to_unit(random[0]), philox::to_unit(random[1]), philox::to_unit(random[2])).array();
 
-#ifdef DPA_FTLE_SUPPORT
-    particles[index] = {distribution(mersenne_twister), iterations, relative_direction::center, process_index};
-#else
-    particles[index] = {distribution(mersenne_twister), iterations, relative_direction::center};
-#endif
+      particles[index] = particle<vector3, integer>(position, iterations, process_index);
+    }
   });
   return particles;
 }
-std::vector<particle<vector3, integer>> uniform_seed_generator::generate_random(vector3 offset, vector3 size, ivector2 range , integer iterations, integer process_index, std::optional<aabb3> aabb)
+std::vector<particle<vector3, integer>> uniform_seed_generator::generate_random(vector3 offset, vector3 size, ivector2 range , integer iterations, integer process_index, std::optional<aabb3> aabb, std::uint32_t seed)
 {
-  std::random_device                         random_device;
-  std::mt19937                               mersenne_twister(random_device());
-  std::uniform_int_distribution<std::size_t> distribution(range[0], range[1]);
-  return generate_random(offset, size, distribution(mersenne_twister), iterations, process_index, aabb);
+  // A separate stream (third counter word) of the same key as the positions.
+  const auto random = philox::generate({0, 0, 1, 0}, {seed, std::uint32_t(process_index)});
+  return generate_random(offset, size, integer(range[0] + random[0] % std::uint32_t(range[1] - range[0] + 1)), iterations, process_index, aabb, seed);
 }
 }
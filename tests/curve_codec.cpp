@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <dpa/utility/curve_codec.hpp>
+
+namespace
+{
+void require_round_trip(const dpa::compressed_integral_curves<dpa::vector3>& curves, const dpa::vector3& origin, const dpa::scalar precision)
+{
+  const auto bytes    = dpa::curve_codec::encode(curves, origin, precision);
+  const auto vertices = dpa::curve_codec::decode(bytes, curves.offsets, origin, precision);
+
+  REQUIRE(vertices.size() == curves.vertices.size());
+  for (std::size_t vertex_index = 0; vertex_index < vertices.size(); ++vertex_index)
+    for (auto i = 0; i < 3; ++i)
+    {
+      // The tolerance of the decoded float accounts for its rounding at the magnitude of the coordinate.
+      const auto error     = std::abs(double(vertices[vertex_index][i]) - double(curves.vertices[vertex_index][i]));
+      const auto tolerance = double(precision) / 2.0 + 4.0 * double(std::numeric_limits<dpa::scalar>::epsilon()) * std::abs(double(curves.vertices[vertex_index][i]));
+      REQUIRE(error <= tolerance);
+    }
+}
+}
+
+TEST_CASE("Curve codec round trips within half the precision", "[curve_codec]")
+{
+  const dpa::vector3 origin   (1.0f, -2.0f, 0.5f);
+  const dpa::scalar  precision = 1e-3f;
+
+  SECTION("Empty curves")
+  {
+    dpa::compressed_integral_curves<dpa::vector3> curves;
+    require_round_trip(curves, origin, precision);
+    REQUIRE(dpa::curve_codec::encode(curves, origin, precision).empty());
+
+    curves.offsets = {0, 0, 0};
+    require_round_trip(curves, origin, precision);
+  }
+  SECTION("Single vertex")
+  {
+    dpa::compressed_integral_curves<dpa::vector3> curves;
+    curves.vertices = {dpa::vector3(3.25f, -7.5f, 12.0f)};
+    curves.offsets  = {0, 1};
+    require_round_trip(curves, origin, precision);
+  }
+  SECTION("Large jumps and negative deltas")
+  {
+    dpa::compressed_integral_curves<dpa::vector3> curves;
+    curves.vertices =
+    {
+      dpa::vector3( 1000.0f, -1000.0f,  0.0f  ),
+      dpa::vector3(-1000.0f,  1000.0f,  0.001f),
+      dpa::vector3(    0.0f,     0.0f, -0.001f),
+      dpa::vector3( 1000.0f,  1000.0f,  1000.0f),
+      dpa::vector3(    1.0f,    -2.0f,  0.5f  ) // The origin.
+    };
+    curves.offsets  = {0, 2, 5};
+    require_round_trip(curves, origin, precision);
+  }
+  SECTION("Random walks")
+  {
+    std::mt19937                          engine(0);
+    std::uniform_real_distribution<float> step  (-0.05f, 0.05f);
+    std::uniform_int_distribution<int>    length(0, 64);
+
+    dpa::compressed_integral_curves<dpa::vector3> curves;
+    curves.offsets.push_back(0);
+    for (auto curve_index = 0; curve_index < 256; ++curve_index)
+    {
+      dpa::vector3 vertex(step(engine) * 100.0f, step(engine) * 100.0f, step(engine) * 100.0f);
+      const auto   size = length(engine);
+      for (auto vertex_index = 0; vertex_index < size; ++vertex_index)
+      {
+        curves.vertices.push_back(vertex);
+        vertex += dpa::vector3(step(engine), step(engine), step(engine));
+      }
+      curves.offsets.push_back(curves.vertices.size());
+    }
+    require_round_trip(curves, origin, precision);
+    require_round_trip(curves, origin, 0.1f);
+  }
+}
+
+TEST_CASE("Curve codec zigzag maps signed to unsigned values and back", "[curve_codec]")
+{
+  for (const std::int64_t value : {std::int64_t(0), std::int64_t(-1), std::int64_t(1), std::int64_t(-64), std::int64_t(63), std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()})
+    REQUIRE(dpa::curve_codec::zigzag_decode(dpa::curve_codec::zigzag_encode(value)) == value);
+  REQUIRE(dpa::curve_codec::zigzag_encode(-1) == 1);
+  REQUIRE(dpa::curve_codec::zigzag_encode( 1) == 2);
+}
@@ -0,0 +1,115 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/mpi/environment.hpp>
+#include <catch2/catch.hpp>
+#include <hdf5.h>
+
+#include <dpa/stages/domain_partitioner.hpp>
+#include <dpa/stages/integral_curve_saver.hpp>
+#include <dpa/stages/integral_curve_spiller.hpp>
+
+namespace
+{
+dpa::domain_partitioner& partitioner()
+{
+  static boost::mpi::environment environment;
+  static dpa::domain_partitioner partitioner = [ ] ()
+  {
+    dpa::domain_partitioner result;
+    result.set_domain_size(dpa::ivector3(8, 8, 8), dpa::ivector3::Ones());
+    return result;
+  } ();
+  return partitioner;
+}
+
+dpa::integral_curves_3d create_integral_curves(const std::size_t round_count)
+{
+  dpa::integral_curves_3d integral_curves(round_count);
+  for (std::size_t round = 0; round < round_count; ++round)
+  {
+    auto& curves = integral_curves[round];
+    curves.offsets.push_back(0);
+    for (std::size_t curve_index = 0; curve_index < 16 + round; ++curve_index)
+    {
+      for (std::size_t vertex_index = 0; vertex_index < 1 + (curve_index + round) % 5; ++vertex_index)
+        curves.vertices.push_back(dpa::vector3(dpa::scalar(round), dpa::scalar(curve_index), dpa::scalar(vertex_index)));
+      curves.offsets.push_back(curves.vertices.size());
+    }
+  }
+  return integral_curves;
+}
+
+template <typename type>
+std::vector<type> read_dataset(const hid_t file, const std::string& name, const hid_t memory_type)
+{
+  const auto dataset = H5Dopen2(file, name.c_str(), H5P_DEFAULT);
+  REQUIRE(dataset >= 0);
+  const auto space   = H5Dget_space(dataset);
+  hsize_t    size    = 0;
+  H5Sget_simple_extent_dims(space, &size, nullptr);
+
+  std::vector<type> data(size);
+  H5Dread(dataset, memory_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data());
+  H5Sclose(space  );
+  H5Dclose(dataset);
+  return data;
+}
+}
+
+TEST_CASE("Integral curve spiller loads the spilled rounds back", "[integral_curve_spiller]")
+{
+  const auto directory = std::filesystem::temp_directory_path() / "dpa_integral_curve_spiller";
+  std::filesystem::create_directories(directory);
+
+  const auto expected        = create_integral_curves(3);
+  auto       integral_curves = expected;
+  integral_curves.emplace_back(); // An empty round is not spilled.
+
+  dpa::integral_curve_spiller spiller(&partitioner(), directory.string(), (directory / "curves.h5").string(), 0);
+  REQUIRE(spiller.spill(integral_curves) == dpa::integral_curve_spiller::memory(expected));
+  REQUIRE(spiller.spilled_memory()       == dpa::integral_curve_spiller::memory(expected));
+  REQUIRE(!spiller.spilled(3));
+
+  for (std::size_t round = 0; round < expected.size(); ++round)
+  {
+    REQUIRE(spiller.spilled(round));
+    REQUIRE(integral_curves[round].offsets.empty());
+
+    const auto curves = spiller.load(round);
+    REQUIRE(curves.vertices == expected[round].vertices);
+    REQUIRE(curves.offsets  == expected[round].offsets );
+  }
+
+  SECTION("Saving")
+  {
+    const auto filepath = (directory / "curves.h5").string();
+    dpa::integral_curve_saver(&partitioner(), filepath, "offsets").save_integral_curves(integral_curves, &spiller);
+
+    const auto file = H5Fopen((directory / "curves.rank_0.h5").string().c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    REQUIRE(file >= 0);
+    for (std::size_t round = 0; round < expected.size(); ++round)
+    {
+      const auto vertices = read_dataset<float>        (file, "vertices_" + std::to_string(round), H5T_NATIVE_FLOAT );
+      const auto offsets  = read_dataset<std::uint64_t>(file, "offsets_"  + std::to_string(round), H5T_NATIVE_UINT64);
+      REQUIRE(vertices.size() == 3 * expected[round].vertices.size());
+      for (std::size_t vertex_index = 0; vertex_index < expected[round].vertices.size(); ++vertex_index)
+        for (auto i = 0; i < 3; ++i)
+          REQUIRE(vertices[3 * vertex_index + i] == expected[round].vertices[vertex_index][i]);
+      REQUIRE(offsets == std::vector<std::uint64_t>(expected[round].offsets.begin(), expected[round].offsets.end()));
+    }
+    H5Fclose(file);
+  }
+  SECTION("Failing load")
+  {
+    std::filesystem::resize_file(directory / "curves.rank_0.spill", 0);
+    REQUIRE_THROWS_AS(spiller.load(0), std::runtime_error);
+
+    const auto filepath = (directory / "curves.h5").string();
+    REQUIRE_THROWS_AS(dpa::integral_curve_saver(&partitioner(), filepath, "offsets").save_integral_curves(integral_curves, &spiller), std::runtime_error);
+  }
+}
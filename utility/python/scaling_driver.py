@@ -0,0 +1,99 @@
+import argparse
+import csv
+import json
+import subprocess
+from pathlib import Path
+
+# Local weak/strong scaling driver. Sweeps the rank counts (through mpiexec), the thread counts (through the thread_count argument)
+# and the problem sizes (through an analytic field of the given dimensions), and consolidates the metrics of each run
+# (see include/dpa/benchmark/scaling_metrics.hpp) into [OUTPUT].csv and [OUTPUT].json.
+# - strong: The problem size is fixed.
+# - weak  : The problem size (the voxel count, hence the seed count) grows with the number of workers (ranks * threads).
+# The parallel efficiency is the speedup in particle steps per second relative to the run with the fewest workers of the same
+# mode and size, over the increase in workers.
+#
+# Example: python scaling_driver.py --executable ../../build/dpa --ranks 1 2 4 --threads 1 2 --sizes 64 128 --modes strong weak
+
+base_configuration = {
+  "input_analytic_field"                 : "abc",
+  "seed_generation_stride"               : [2, 2, 2],
+  "seed_generation_iterations"           : 1000,
+  "particle_advector_particles_per_round": 100000,
+  "particle_advector_load_balancer"      : "none",
+  "particle_advector_integrator"         : "runge_kutta_4",
+  "particle_advector_step_size"          : 0.01,
+  "particle_advector_gather_particles"   : False,
+  "particle_advector_record"             : False
+}
+
+def run(arguments, configuration, name, ranks):
+  configuration_filepath = Path(arguments.directory) / (name + ".json")
+  configuration["output_dataset_filepath"] = str(Path(arguments.directory) / (name + ".h5"))
+  with open(configuration_filepath, 'w') as file:
+    json.dump(configuration, file, indent=2)
+
+  command = [arguments.mpiexec, "-n", str(ranks)] + arguments.mpiexec_flags.split() + [arguments.executable, str(configuration_filepath)]
+  with open(Path(arguments.directory) / (name + ".log"), 'w') as log:
+    subprocess.run(command, stdout=log, stderr=subprocess.STDOUT, check=True)
+
+  with open(configuration["output_dataset_filepath"] + ".metrics.json") as file:
+    return json.load(file)
+
+def summarize(metrics):
+  rounds = [round for iteration in metrics["iterations"] for round in iteration["rounds"]]
+  steps  = sum(round["particle_steps"] for round in rounds)
+  return {
+    "particle_steps_per_second"    : metrics["particle_steps_per_second"],
+    "wall_time"                    : sum(iteration["wall_time"] for iteration in metrics["iterations"]) / max(len(metrics["iterations"]), 1),
+    "maximum_advection_imbalance"  : max((round["advection_imbalance"] for round in rounds), default = 1.0),
+    "weighted_advection_imbalance" : sum(round["advection_imbalance"] * round["particle_steps"] for round in rounds) / steps if steps > 0 else 1.0}
+
+def sweep(arguments):
+  configuration = base_configuration
+  if arguments.config:
+    with open(arguments.config) as file:
+      configuration = json.load(file)
+
+  results = []
+  for mode in arguments.modes:
+    for size in arguments.sizes:
+      baseline = None
+      for ranks in arguments.ranks:
+        for threads in arguments.threads:
+          workers    = ranks * threads
+          base       = arguments.ranks[0] * arguments.threads[0]
+          dimensions = size if mode == "strong" else round(size * (workers / base) ** (1.0 / 3.0))
+          name       = "scaling_" + mode + "_s" + str(size) + "_r" + str(ranks) + "_t" + str(threads)
+          print("Running " + name)
+
+          run_configuration = dict(configuration)
+          run_configuration["input_analytic_field_dimensions"] = [dimensions, dimensions, dimensions]
+          run_configuration["thread_count"                   ] = threads
+          result = {"mode": mode, "size": size, "dimensions": dimensions, "ranks": ranks, "threads": threads, "workers": workers}
+          result.update(summarize(run(arguments, run_configuration, name, ranks)))
+
+          if baseline is None:
+            baseline = result
+          result["speedup"   ] = result["particle_steps_per_second"] / baseline["particle_steps_per_second"] if baseline["particle_steps_per_second"] > 0 else 0.0
+          result["efficiency"] = result["speedup"] / (workers / baseline["workers"])
+          results.append(result)
+
+  with open(arguments.output + ".json", 'w') as file:
+    json.dump(results, file, indent=2)
+  with open(arguments.output + ".csv", 'w', newline = '') as file:
+    writer = csv.DictWriter(file, fieldnames = results[0].keys())
+    writer.writeheader()
+    writer.writerows(results)
+
+parser = argparse.ArgumentParser(description = "Local weak/strong scaling driver.")
+parser.add_argument("--executable"   , required = True)
+parser.add_argument("--config"       , help     = "Base configuration. The analytic field dimensions, thread count and output are overridden.")
+parser.add_argument("--ranks"        , type     = int, nargs = '+', default = [1, 2, 4])
+parser.add_argument("--threads"      , type     = int, nargs = '+', default = [1])
+parser.add_argument("--sizes"        , type     = int, nargs = '+', default = [64])
+parser.add_argument("--modes"        , nargs    = '+', default = ["strong", "weak"], choices = ["strong", "weak"])
+parser.add_argument("--mpiexec"      , default  = "mpiexec")
+parser.add_argument("--mpiexec_flags", default  = "")
+parser.add_argument("--directory"    , default  = ".")
+parser.add_argument("--output"       , default  = "scaling")
+sweep(parser.parse_args())